@@ -0,0 +1,317 @@
+// Microbenchmarks for Matrices, Particle/ParticleSystem, ForceField and Color_Space.
+//
+// Every benchmark is warmed up, then timed in repeated batches sized to take
+// about BATCH_MS each. The table reports the median ns/op across batches, the
+// fastest batch, the spread (median absolute deviation as a percentage of the
+// median) and heap allocations per op, counted by src/AllocationTracker.cpp
+// (0 unless built with -DTRACK_ALLOCATIONS). --json writes the same numbers
+// for diffing between commits.
+//
+// "frame/N" steps a ParticleSystem holding N live particles the way Engine
+// does (removeDead, advance the clock, build the vertex batch across the
+// thread pool), topping the population back up to N with a batch spawn each frame.
+// "interact/N" does the same without building vertices, stepping ParticleInteractions
+// instead: repulsion within 8 units and bounces off the default window.
+//
+// usage: micro_bench [--filter SUBSTRING] [--json FILE]
+
+#include "AllocationTracker.h"
+#include "ForceField.h"
+#include "Matrices.h"
+#include "ParticleInteractions.h"
+#include "ParticleSystem.h"
+#include "ThreadPool.h"
+#include "config.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double constexpr BATCH_MS = 20;
+double constexpr WARMUP_MS = 100;
+int constexpr REPETITIONS = 11;
+Config const DEFAULTS; // the shipped settings
+float const DT = 1.f / DEFAULTS.targetFps;
+
+// keep value (and everything it points to) observable so the work is not optimised away
+template <class T> void keep(T const& value) { asm volatile("" : : "g"(&value) : "memory"); }
+
+struct Benchmark {
+    std::string name;
+    std::function<void(size_t iterations)> run;
+};
+
+struct Result {
+    std::string name;
+    size_t iterations = 0; // per batch
+    double nsPerOp = 0;    // median batch
+    double minNsPerOp = 0;
+    double spreadPct = 0;
+    double allocsPerOp = 0;
+};
+
+double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+Result measure(Benchmark const& benchmark)
+{
+    // warm caches and lazily built tables, and find a batch size near BATCH_MS
+    size_t iterations = 1;
+    Clock::time_point const warmupStart = Clock::now();
+    while (true) {
+        Clock::time_point const start = Clock::now();
+        benchmark.run(iterations);
+        double const ms = elapsedMs(start);
+        if (ms >= BATCH_MS || (elapsedMs(warmupStart) >= WARMUP_MS && ms > 0)) {
+            iterations = std::max<size_t>(1, iterations * BATCH_MS / ms);
+            break;
+        }
+        iterations *= 2;
+    }
+
+    std::vector<double> nsPerOp;
+    nsPerOp.reserve(REPETITIONS); // so the harness does not allocate while counting
+    size_t const allocationsBefore = allocation_count();
+    for (int rep = 0; rep < REPETITIONS; rep++) {
+        Clock::time_point const start = Clock::now();
+        benchmark.run(iterations);
+        nsPerOp.push_back(elapsedMs(start) * 1e6 / iterations);
+    }
+    size_t const allocations = allocation_count() - allocationsBefore;
+
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    Result result;
+    result.name = benchmark.name;
+    result.iterations = iterations;
+    result.nsPerOp = nsPerOp[REPETITIONS / 2];
+    result.minNsPerOp = nsPerOp.front();
+
+    std::vector<double> deviations;
+    for (double ns : nsPerOp) {
+        deviations.push_back(std::abs(ns - result.nsPerOp));
+    }
+    std::sort(deviations.begin(), deviations.end());
+    result.spreadPct = 100 * deviations[REPETITIONS / 2] / result.nsPerOp;
+    result.allocsPerOp = static_cast<double>(allocations) / (iterations * REPETITIONS);
+    return result;
+}
+
+std::vector<Benchmark> benchmarks()
+{
+    std::vector<Benchmark> all;
+
+    // ---- Matrices ----
+    all.push_back({ "Matrix operator* (2x2 * 2x33)", [](size_t n) {
+                       RotationMatrix const r(0.1f);
+                       Matrix const points(2, 33);
+                       for (size_t i = 0; i < n; i++) {
+                           Matrix const product = r * points;
+                           keep(product);
+                       }
+                   } });
+    all.push_back({ "Matrix operator+ (2x33)", [](size_t n) {
+                       TranslationMatrix const t(1, 2, 33);
+                       Matrix const points(2, 33);
+                       for (size_t i = 0; i < n; i++) {
+                           Matrix const sum = t + points;
+                           keep(sum);
+                       }
+                   } });
+    all.push_back({ "Matrix invert (3x3)", [](size_t n) {
+                       Matrix const m({ { 4, 1, 2 }, { 1, 5, 3 }, { 2, 3, 6 } });
+                       for (size_t i = 0; i < n; i++) {
+                           Matrix const inverse = m.invert();
+                           keep(inverse);
+                       }
+                   } });
+
+    // ---- Particle ----
+    // systems persist across batches so setup stays out of the timings
+    auto spawned = std::make_shared<ParticleSystem>();
+    spawned->reserve(ParticleSystem::MIN_CAPACITY);
+    all.push_back({ "ParticleSystem::spawn", [spawned](size_t n) {
+                       for (size_t i = 0; i < n; i++) {
+                           if (spawned->size() == spawned->capacity()) {
+                               spawned->clear();
+                           }
+                           keep(spawned->spawn(sf::Color::Red, { 0, 0 }));
+                       }
+                   } });
+
+    auto single = std::make_shared<ParticleSystem>();
+    all.push_back({ "Particle::update + getCenter", [single](size_t n) {
+                       for (size_t i = 0; i < n; i++) {
+                           // respawn well before the particle's lifetime runs out
+                           if (i % 1024 == 0) {
+                               single->clear();
+                               single->spawn(sf::Color::Red, { 0, 0 });
+                           }
+                           Particle p = (*single)[0];
+                           p.update(1e-6f);
+                           keep(p.getCenter());
+                       }
+                   } });
+
+    auto pool = std::make_shared<ThreadPool>();
+    sf::Color const palette[] = { sf::Color::Red, sf::Color::Green, sf::Color::Blue };
+    for (size_t population : { 1000, 10000, 100000 }) {
+        auto particles = std::make_shared<ParticleSystem>();
+        particles->setThreadPool(pool.get());
+        particles->spawn(population, { 0, 0 }, palette, 3, 0);
+        all.push_back({ "frame/" + std::to_string(population),
+            [particles, pool, population, palette](size_t n) {
+                for (size_t i = 0; i < n; i++) {
+                    particles->removeDead();
+                    particles->update(DT);
+                    particles->spawn(population - particles->size(), { 0, 0 }, palette, 3, 0);
+                    keep(particles->buildBatch());
+                }
+            } });
+    }
+
+    // the same frames with particles repelling their neighbours and bouncing off the window
+    for (size_t population : { 10000, 100000 }) {
+        auto particles = std::make_shared<ParticleSystem>();
+        auto interactions = std::make_shared<ParticleInteractions>();
+        particles->setThreadPool(pool.get());
+        particles->spawn(population, { 0, 0 }, palette, 3, 0);
+        interactions->setThreadPool(pool.get());
+        interactions->setSettings({ 8, 0, 4000, 0, true, 0.6f });
+        sf::FloatRect const window(-DEFAULTS.windowWidth / 2.f, -DEFAULTS.windowHeight / 2.f,
+            DEFAULTS.windowWidth, DEFAULTS.windowHeight);
+        all.push_back({ "interact/" + std::to_string(population),
+            [particles, interactions, pool, population, palette, window](size_t n) {
+                for (size_t i = 0; i < n; i++) {
+                    particles->removeDead();
+                    particles->update(DT);
+                    particles->spawn(population - particles->size(), { 0, 0 }, palette, 3, 0);
+                    interactions->step(*particles, DT, window);
+                    keep(interactions->getGrid().size());
+                }
+            } });
+    }
+
+    // baked vortex + turbulence over the default window, sampled at scattered positions
+    auto field = std::make_shared<ForceField>();
+    field->add(ForceSource::vortex({ 0, 0 }, 3000, 300));
+    field->add(ForceSource::turbulence(800, 200));
+    field->bake({ -DEFAULTS.windowWidth / 2.f, -DEFAULTS.windowHeight / 2.f,
+                    float(DEFAULTS.windowWidth), float(DEFAULTS.windowHeight) },
+        0);
+    auto fieldX = std::make_shared<std::vector<float>>(100000);
+    auto fieldY = std::make_shared<std::vector<float>>(100000);
+    for (size_t i = 0; i < fieldX->size(); i++) {
+        (*fieldX)[i] = (i * 7919 % 1920) - 960.f;
+        (*fieldY)[i] = (i * 104729 % 1080) - 540.f;
+    }
+    auto fieldVx = std::make_shared<std::vector<float>>(100000);
+    auto fieldVy = std::make_shared<std::vector<float>>(100000);
+    all.push_back({ "ForceField::accelerate (100000)",
+        [field, fieldX, fieldY, fieldVx, fieldVy](size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                field->accelerate(fieldX->data(), fieldY->data(), fieldVx->data(), fieldVy->data(),
+                    fieldX->size(), DT);
+                keep(*fieldVx);
+            }
+        } });
+
+    // ---- Color_Space ----
+    all.push_back({ "get_rainbow_colors(1500)", [](size_t n) {
+                       for (size_t i = 0; i < n; i++) {
+                           keep(get_rainbow_colors(
+                               DEFAULTS.particlesPerSecond * DEFAULTS.secondsPerRainbowCycle));
+                       }
+                   } });
+    all.push_back({ "clrspc::ok_lab_to_rgb (1024 colors)", [](size_t n) {
+                       std::vector<float> L(1024, 0.7f), a(1024, 0.1f), b(1024, -0.05f);
+                       std::vector<float> red(1024), green(1024), blue(1024);
+                       for (size_t i = 0; i < n; i++) {
+                           clrspc::ok_lab_to_rgb(L.data(), a.data(), b.data(), red.data(),
+                               green.data(), blue.data(), 1024);
+                           keep(red);
+                       }
+                   } });
+    all.push_back({ "clrspc::Ok_Lab::to_rgb", [](size_t n) {
+                       clrspc::Ok_Lab lab(0.7f, 0.1f, -0.05f);
+                       for (size_t i = 0; i < n; i++) {
+                           keep(lab);
+                           keep(lab.to_rgb());
+                       }
+                   } });
+
+    return all;
+}
+
+void writeJson(std::string const& path, std::vector<Result> const& results)
+{
+    std::ofstream file(path);
+    file << std::setprecision(6) << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        Result const& r = results[i];
+        file << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name
+             << "\", \"ns_per_op\": " << r.nsPerOp << ", \"min_ns_per_op\": " << r.minNsPerOp
+             << ", \"spread_pct\": " << r.spreadPct << ", \"allocs_per_op\": " << r.allocsPerOp
+             << ", \"iterations\": " << r.iterations << "}";
+    }
+    file << "\n  ]\n}\n";
+
+    if (!file) {
+        std::cerr << "Failed to write " << path << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        }
+    }
+
+    seed_random(1); // the same particles every run
+
+    std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(14)
+              << "ns/op" << std::setw(14) << "min ns/op" << std::setw(10) << "spread"
+              << std::setw(12) << "allocs/op" << '\n';
+
+    std::vector<Result> results;
+    for (Benchmark const& benchmark : benchmarks()) {
+        if (benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        Result const r = measure(benchmark);
+        results.push_back(r);
+
+        std::cout << std::left << std::setw(40) << r.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(14) << r.nsPerOp << std::setw(14)
+                  << r.minNsPerOp << std::setw(9) << r.spreadPct << '%' << std::setw(12)
+                  << std::setprecision(2) << r.allocsPerOp << std::endl;
+    }
+
+    if (!jsonPath.empty()) {
+        writeJson(jsonPath, results);
+    }
+}
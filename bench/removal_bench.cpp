@@ -0,0 +1,141 @@
+// Frame time vs spawn rate for each dead-particle removal strategy.
+//
+// "vector::erase" reproduces the removal loop Engine::update used before the
+// particle pool: a std::vector of particle-sized elements with one erase per
+// expired element. The other rows drive a real ParticleSystem with each
+// RemovalPolicy. Every row spawns the same number of particles per frame at a
+// fixed dt. The "remove" column compares removal alone; the "frame" column of
+// the vector::erase rows covers only spawning, TTL countdown and removal, while
+// the pool rows also run the full ParticleSystem::update.
+//
+// usage: removal_bench [frames]
+
+#include "ParticleSystem.h"
+#include "config.h"
+#include "util.h"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Config const DEFAULTS; // the shipped settings
+float const DT = 1.f / DEFAULTS.targetFps;
+
+struct Result {
+    double removeMs = 0; // per frame
+    double frameMs = 0;  // per frame
+    size_t peakLive = 0;
+};
+
+double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// roughly the footprint of the old by-value Particle
+struct LegacyParticle {
+    float ttl;
+    std::array<char, 252> payload;
+};
+
+Result runLegacy(int spawnRate, int frames)
+{
+    std::vector<LegacyParticle> particles;
+    Result result;
+    float accumulator = 0.f;
+
+    for (int frame = 0; frame < frames; frame++) {
+        Clock::time_point const frameStart = Clock::now();
+
+        accumulator += spawnRate * DT;
+        while (accumulator >= 1.f) {
+            particles.push_back({ static_cast<float>(getRandDouble(0, DEFAULTS.ttl)), {} });
+            accumulator -= 1.f;
+        }
+
+        Clock::time_point const removeStart = Clock::now();
+        std::vector<LegacyParticle>::iterator it = particles.begin();
+        while (it != particles.end()) {
+            if (it->ttl > 0.0) {
+                it->ttl -= DT;
+                ++it;
+            } else {
+                it = particles.erase(it);
+            }
+        }
+        result.removeMs += elapsedMs(removeStart);
+        result.frameMs += elapsedMs(frameStart);
+        result.peakLive = std::max(result.peakLive, particles.size());
+    }
+
+    result.removeMs /= frames;
+    result.frameMs /= frames;
+    return result;
+}
+
+Result runPool(ParticleSystem::RemovalPolicy policy, int spawnRate, int frames)
+{
+    ParticleSystem particles;
+    particles.setRemovalPolicy(policy);
+
+    Vector2f const emitter(0, 0);
+    Result result;
+    float accumulator = 0.f;
+
+    for (int frame = 0; frame < frames; frame++) {
+        Clock::time_point const frameStart = Clock::now();
+
+        accumulator += spawnRate * DT;
+        while (accumulator >= 1.f) {
+            particles.spawn(sf::Color::Red, emitter);
+            accumulator -= 1.f;
+        }
+
+        Clock::time_point const removeStart = Clock::now();
+        particles.removeDead();
+        result.removeMs += elapsedMs(removeStart);
+
+        particles.update(DT);
+        result.frameMs += elapsedMs(frameStart);
+        result.peakLive = std::max(result.peakLive, particles.size());
+    }
+
+    result.removeMs /= frames;
+    result.frameMs /= frames;
+    return result;
+}
+
+void printRow(int spawnRate, std::string const& strategy, Result const& result)
+{
+    std::cout << std::setw(10) << spawnRate << std::setw(18) << strategy << std::setw(10)
+              << result.peakLive << std::fixed << std::setprecision(4) << std::setw(14)
+              << result.removeMs << std::setw(14) << result.frameMs << '\n';
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int const frames = (argc > 1) ? std::atoi(argv[1]) : 300;
+    std::vector<int> const spawnRates = { DEFAULTS.particlesPerSecond, 1000, 3000, 10000, 30000 };
+
+    std::cout << frames << " frames per row at dt = " << DT << "s, times in ms per frame\n";
+    std::cout << std::setw(10) << "spawn/s" << std::setw(18) << "strategy" << std::setw(10)
+              << "peak" << std::setw(14) << "remove" << std::setw(14) << "frame" << '\n';
+
+    for (int spawnRate : spawnRates) {
+        printRow(spawnRate, "vector::erase", runLegacy(spawnRate, frames));
+        printRow(spawnRate, "stable",
+            runPool(ParticleSystem::RemovalPolicy::Stable, spawnRate, frames));
+        printRow(spawnRate, "swap-and-pop",
+            runPool(ParticleSystem::RemovalPolicy::SwapAndPop, spawnRate, frames));
+    }
+}
@@ -3,12 +3,19 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
 
 #define _USE_MATH_DEFINES // for VS
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CLRSPC_SSE2
+#endif
+
 namespace clrspc {
 
 // forward declarations
@@ -62,6 +69,18 @@ public:
     void print() const override;
 };
 
+// sRGB (0-255) around the OkLCh hue circle at a fixed lightness and chroma.
+// Linear RGB is sampled every 360 / size degrees, before gamut clipping so it stays
+// smooth, interpolated in between and then encoded through linear_to_srgb()
+class Ok_Lch_Hue_Table {
+    std::vector<std::array<float, 3>> m_linear; // size + 1 entries, the last wraps to hue 0
+
+public:
+    Ok_Lch_Hue_Table(float l, float c, int size = 360);
+
+    [[nodiscard]] std::array<float, 3> at(float hue_degrees) const;
+};
+
 class Rgb : public Color {
 public:
     Rgb(float r, float g, float b);
@@ -104,6 +123,361 @@ inline std::array<float, 3> polar_to_cartesian(std::array<float, 3> const& polar
     return { l, a, b };
 }
 
+// sRGB transfer functions, channels in [0, 255] and linear light in [0, 1]
+inline float srgb_decode(float c)
+{
+    c = std::fmax(0.f, c / 255.f); // normalize and avoid negatives
+    return (c <= 0.04045f) ? c / 12.92f : std::exp2f(std::log2f((c + 0.055f) / 1.055f) * 2.4f);
+}
+
+inline float srgb_encode(float c)
+{
+    c = std::fmax(0.f, c);
+    float encoded
+        = (c <= 0.0031308f) ? 12.92f * c : 1.055f * std::exp2f(std::log2f(c) * 0.41666f) - 0.055f;
+    return encoded * 255.f;
+}
+
+inline std::array<float, 3> ok_lab_to_linear_rgb(float L, float a, float b)
+{
+    float l_ = L + 0.3963377774f * a + 0.2158037573f * b;
+    float m_ = L - 0.1055613458f * a - 0.0638541728f * b;
+    float s_ = L - 0.0894841775f * a - 1.2914855480f * b;
+
+    float l = l_ * l_ * l_;
+    float m = m_ * m_ * m_;
+    float s = s_ * s_ * s_;
+
+    return {
+        +4.0767416621f * l - 3.3077115913f * m + 0.2309699292f * s,
+        -1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s,
+        -0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s,
+    };
+}
+
+// =========== Lookup Tables ==========
+
+// linear_to_srgb() samples [0, 1] this many times
+inline constexpr int LINEAR_TO_SRGB_SIZE = 4096;
+
+// srgb_decode() of every 8-bit channel value
+inline std::array<float, 256> const& srgb_to_linear_table()
+{
+    static std::array<float, 256> const table = [] {
+        std::array<float, 256> t;
+        for (int i = 0; i < 256; i++) {
+            t[i] = srgb_decode(i);
+        }
+        return t;
+    }();
+    return table;
+}
+
+// srgb_encode() at LINEAR_TO_SRGB_SIZE + 1 evenly spaced points of [0, 1]
+inline std::array<float, LINEAR_TO_SRGB_SIZE + 1> const& linear_to_srgb_table()
+{
+    static std::array<float, LINEAR_TO_SRGB_SIZE + 1> const table = [] {
+        std::array<float, LINEAR_TO_SRGB_SIZE + 1> t;
+        for (int i = 0; i <= LINEAR_TO_SRGB_SIZE; i++) {
+            t[i] = srgb_encode(static_cast<float>(i) / LINEAR_TO_SRGB_SIZE);
+        }
+        return t;
+    }();
+    return table;
+}
+
+inline float srgb_to_linear(uint8_t c) { return srgb_to_linear_table()[c]; }
+
+// srgb_encode() by table lookup; within 0.005 (of 255) of it over [0, 1], exact outside
+inline float linear_to_srgb(float c)
+{
+    if (!(c > 0.f)) {
+        return 0.f;
+    }
+    if (c >= 1.f) {
+        return srgb_encode(c); // out of gamut, leave to the caller to clamp
+    }
+
+    auto const& table = linear_to_srgb_table();
+    float const x = c * LINEAR_TO_SRGB_SIZE;
+    int const i = static_cast<int>(x);
+    return table[i] + (x - i) * (table[i + 1] - table[i]);
+}
+
+// Ok_Lab::to_rgb() without the Color objects, encoding through linear_to_srgb()
+inline std::array<float, 3> ok_lab_to_rgb(float L, float a, float b)
+{
+    auto [r, g, b_] = ok_lab_to_linear_rgb(L, a, b);
+    return { linear_to_srgb(r), linear_to_srgb(g), linear_to_srgb(b_) };
+}
+
+// =========== Batch Conversions ==========
+
+// Structure-of-arrays conversions: each reads n values from every input channel
+// array and writes n values to every output channel array; outputs may alias
+// inputs. With SSE2 they run four colors at a time, with cbrt, pow, sin and cos
+// replaced by the polynomial approximations below; leftover colors (and builds
+// without SSE2) use the library functions. Either way channels stay within
+// 0.01 (of 255) of the exact path and OkLab within 1e-5.
+
+namespace detail {
+
+// the same code runs on float and on four packed floats (F4) through these overloads
+inline float vsqrt(float x) { return std::sqrt(x); }
+inline float vmax(float a, float b) { return a > b ? a : b; }
+inline float select_lt(float x, float limit, float a, float b) { return x < limit ? a : b; }
+inline float vfloor(float x) { return std::floor(x); }
+inline uint32_t to_bits(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof bits);
+    return bits;
+}
+inline float from_bits(uint32_t bits)
+{
+    float x;
+    std::memcpy(&x, &bits, sizeof x);
+    return x;
+}
+inline float to_float(uint32_t i) { return static_cast<float>(static_cast<int32_t>(i)); }
+inline uint32_t to_int(float x) { return static_cast<uint32_t>(static_cast<int32_t>(x)); }
+
+#ifdef CLRSPC_SSE2
+struct F4 {
+    __m128 v;
+    F4(__m128 v)
+        : v(v)
+    {
+    }
+    F4(float x)
+        : v(_mm_set1_ps(x))
+    {
+    }
+};
+struct I4 {
+    __m128i v;
+    I4(__m128i v)
+        : v(v)
+    {
+    }
+    I4(uint32_t x)
+        : v(_mm_set1_epi32(static_cast<int32_t>(x)))
+    {
+    }
+};
+
+inline F4 operator+(F4 a, F4 b) { return _mm_add_ps(a.v, b.v); }
+inline F4 operator-(F4 a, F4 b) { return _mm_sub_ps(a.v, b.v); }
+inline F4 operator*(F4 a, F4 b) { return _mm_mul_ps(a.v, b.v); }
+inline F4 operator/(F4 a, F4 b) { return _mm_div_ps(a.v, b.v); }
+inline F4 vsqrt(F4 x) { return _mm_sqrt_ps(x.v); }
+inline F4 vmax(F4 a, F4 b) { return _mm_max_ps(a.v, b.v); }
+inline F4 select_lt(F4 x, F4 limit, F4 a, F4 b)
+{
+    __m128 const mask = _mm_cmplt_ps(x.v, limit.v);
+    return _mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v));
+}
+inline F4 vfloor(F4 x)
+{
+    // truncate, then step down where that rounded a negative value up
+    __m128 const t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x.v));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x.v), _mm_set1_ps(1.f)));
+}
+
+inline I4 operator+(I4 a, I4 b) { return _mm_add_epi32(a.v, b.v); }
+inline I4 operator-(I4 a, I4 b) { return _mm_sub_epi32(a.v, b.v); }
+inline I4 operator&(I4 a, I4 b) { return _mm_and_si128(a.v, b.v); }
+inline I4 operator|(I4 a, I4 b) { return _mm_or_si128(a.v, b.v); }
+inline I4 operator>>(I4 a, int n) { return _mm_srli_epi32(a.v, n); }
+inline I4 operator<<(I4 a, int n) { return _mm_slli_epi32(a.v, n); }
+inline I4 to_bits(F4 x) { return _mm_castps_si128(x.v); }
+inline F4 from_bits(I4 i) { return _mm_castsi128_ps(i.v); }
+inline F4 to_float(I4 i) { return _mm_cvtepi32_ps(i.v); }
+inline I4 to_int(F4 x) { return _mm_cvttps_epi32(x.v); }
+#endif
+
+// cube root of any sign: exponent-divided bit guess, then two Newton steps
+template <class V> inline V fast_cbrt(V x)
+{
+    auto const sign = to_bits(x) & 0x80000000u;
+    V const ax = from_bits(to_bits(x) & 0x7fffffffu);
+
+    V y = from_bits(to_int(to_float(to_bits(ax)) * V(1.f / 3.f)) + 0x2a514067u);
+    y = (V(2.f) * y + ax / (y * y)) * V(1.f / 3.f);
+    y = (V(2.f) * y + ax / (y * y)) * V(1.f / 3.f);
+
+    return from_bits(to_bits(y) | sign);
+}
+
+// log2 of a positive normal float: exponent plus an odd series in (m - 1) / (m + 1)
+template <class V> inline V fast_log2(V x)
+{
+    auto const bits = to_bits(x);
+    V const exponent = to_float((bits >> 23) & 0xffu) - V(127.f);
+    V const m = from_bits((bits & 0x007fffffu) | 0x3f800000u); // mantissa in [1, 2)
+
+    V const t = (m - V(1.f)) / (m + V(1.f));
+    V const t2 = t * t;
+    V const series = t
+        * (V(2.f)
+            + t2 * (V(2.f / 3.f) + t2 * (V(2.f / 5.f) + t2 * (V(2.f / 7.f) + t2 * V(2.f / 9.f)))));
+    return exponent + series * V(1.4426950409f); // ln -> log2
+}
+
+// 2^y for y in [-126, 126]: integer part into the exponent, fraction by series
+template <class V> inline V fast_exp2(V y)
+{
+    V const whole = vfloor(y);
+    V const f = (y - whole) * V(0.6931471806f); // e^f, f in [0, ln 2)
+
+    V const series = V(1.f)
+        + f * (V(1.f) + f * (V(1.f / 2) + f * (V(1.f / 6) + f * (V(1.f / 24)
+                  + f * (V(1.f / 120) + f * (V(1.f / 720) + f * V(1.f / 5040)))))));
+    return series * from_bits((to_int(whole) + 127u) << 23);
+}
+
+// sin for any x: fold into [-pi/2, pi/2] by symmetry, then an odd Taylor series
+template <class V> inline V fast_sin(V x)
+{
+    V const two_pi = V(6.2831853072f);
+    x = x - two_pi * vfloor((x + V(3.1415926536f)) / two_pi); // [-pi, pi)
+    x = select_lt(V(1.5707963268f), x, V(3.1415926536f) - x, x);
+    x = select_lt(x, V(-1.5707963268f), V(-3.1415926536f) - x, x);
+
+    V const x2 = x * x;
+    return x
+        * (V(1.f) + x2 * (V(-1.f / 6) + x2 * (V(1.f / 120) + x2 * (V(-1.f / 5040)
+                  + x2 * (V(1.f / 362880) + x2 * V(-1.f / 39916800))))));
+}
+
+// one color at a time the library functions are quicker than the approximations
+inline float vcbrt(float x) { return std::cbrt(x); }
+inline float vpow(float x, float y) { return std::exp2f(std::log2f(x) * y); }
+inline float vsin(float x) { return std::sin(x); }
+
+#ifdef CLRSPC_SSE2
+inline F4 vcbrt(F4 x) { return fast_cbrt(x); }
+inline F4 vpow(F4 x, float y) { return fast_exp2(fast_log2(x) * F4(y)); }
+inline F4 vsin(F4 x) { return fast_sin(x); }
+#endif
+
+template <class V> inline V fast_srgb_decode(V c)
+{
+    c = vmax(V(0.f), c * V(1.f / 255.f));
+    V const curve = vpow((c + V(0.055f)) * V(1.f / 1.055f), 2.4f);
+    return select_lt(V(0.04045f), c, curve, c * V(1.f / 12.92f));
+}
+
+template <class V> inline V fast_srgb_encode(V c)
+{
+    c = vmax(V(0.f), c);
+    V const safe = vmax(V(0.0031308f), c); // keep log2 away from 0 on the unused branch
+    V const curve = V(1.055f) * vpow(safe, 0.41666f) - V(0.055f);
+    return select_lt(V(0.0031308f), c, curve, V(12.92f) * c) * V(255.f);
+}
+
+template <class V> inline void rgb_to_ok_lab(V r, V g, V b, V& L, V& A, V& B)
+{
+    V const r_lin = fast_srgb_decode(r);
+    V const g_lin = fast_srgb_decode(g);
+    V const b_lin = fast_srgb_decode(b);
+
+    V const l_ = vcbrt(V(0.4122214708f) * r_lin + V(0.5363325363f) * g_lin
+        + V(0.0514459929f) * b_lin);
+    V const m_ = vcbrt(V(0.2119034982f) * r_lin + V(0.6806995451f) * g_lin
+        + V(0.1073969566f) * b_lin);
+    V const s_ = vcbrt(V(0.0883024619f) * r_lin + V(0.2817188376f) * g_lin
+        + V(0.6299787005f) * b_lin);
+
+    L = V(0.2104542553f) * l_ + V(0.7936177850f) * m_ - V(0.0040720468f) * s_;
+    A = V(1.9779984951f) * l_ - V(2.4285922050f) * m_ + V(0.4505937099f) * s_;
+    B = V(0.0259040371f) * l_ + V(0.7827717662f) * m_ - V(0.8086757660f) * s_;
+}
+
+template <class V> inline void ok_lab_to_rgb(V L, V A, V B, V& r, V& g, V& b)
+{
+    V const l_ = L + V(0.3963377774f) * A + V(0.2158037573f) * B;
+    V const m_ = L - V(0.1055613458f) * A - V(0.0638541728f) * B;
+    V const s_ = L - V(0.0894841775f) * A - V(1.2914855480f) * B;
+
+    V const l = l_ * l_ * l_;
+    V const m = m_ * m_ * m_;
+    V const s = s_ * s_ * s_;
+
+    r = fast_srgb_encode(V(4.0767416621f) * l - V(3.3077115913f) * m + V(0.2309699292f) * s);
+    g = fast_srgb_encode(V(-1.2684380046f) * l + V(2.6097574011f) * m - V(0.3413193965f) * s);
+    b = fast_srgb_encode(V(-0.0041960863f) * l - V(0.7034186147f) * m + V(1.7076147010f) * s);
+}
+
+template <class V> inline void ok_lch_ab_to_ok_lab(V l, V c, V h, V& L, V& A, V& B)
+{
+    V const h_rad = h * V(static_cast<float>(M_PI / 180));
+
+    L = l;
+    A = c * vsin(h_rad + V(1.5707963268f));
+    B = c * vsin(h_rad);
+}
+
+// run kernel over n elements of three input and three output channels
+template <class Kernel>
+inline void for_each_color(float const* x, float const* y, float const* z, float* out_x,
+    float* out_y, float* out_z, size_t n, Kernel kernel)
+{
+    size_t tail = 0;
+
+#ifdef CLRSPC_SSE2
+    tail = n - n % 4;
+    for (size_t i = 0; i < tail; i += 4) {
+        F4 ox = 0.f, oy = 0.f, oz = 0.f;
+        kernel(F4(_mm_loadu_ps(x + i)), F4(_mm_loadu_ps(y + i)), F4(_mm_loadu_ps(z + i)), ox, oy,
+            oz);
+        _mm_storeu_ps(out_x + i, ox.v);
+        _mm_storeu_ps(out_y + i, oy.v);
+        _mm_storeu_ps(out_z + i, oz.v);
+    }
+#endif
+
+    for (size_t i = tail; i < n; i++) {
+        float ox, oy, oz;
+        kernel(x[i], y[i], z[i], ox, oy, oz);
+        out_x[i] = ox;
+        out_y[i] = oy;
+        out_z[i] = oz;
+    }
+}
+
+} // namespace detail
+
+// sRGB channels in [0, 255] -> OkLab
+inline void rgb_to_ok_lab(float const* r, float const* g, float const* b, float* L, float* a,
+    float* b_out, size_t n)
+{
+    detail::for_each_color(r, g, b, L, a, b_out, n,
+        [](auto r, auto g, auto b, auto& L, auto& a, auto& b_out) {
+            detail::rgb_to_ok_lab(r, g, b, L, a, b_out);
+        });
+}
+
+// OkLab -> sRGB channels in [0, 255]; negatives clip to 0, values over 255 are left to the caller
+inline void ok_lab_to_rgb(float const* L, float const* a, float const* b, float* r, float* g,
+    float* b_out, size_t n)
+{
+    detail::for_each_color(L, a, b, r, g, b_out, n,
+        [](auto L, auto a, auto b, auto& r, auto& g, auto& b_out) {
+            detail::ok_lab_to_rgb(L, a, b, r, g, b_out);
+        });
+}
+
+// OkLCh, hue in degrees -> OkLab
+inline void ok_lch_ab_to_ok_lab(float const* l, float const* c, float const* h, float* L, float* a,
+    float* b, size_t n)
+{
+    detail::for_each_color(l, c, h, L, a, b, n,
+        [](auto l, auto c, auto h, auto& L, auto& a, auto& b) {
+            detail::ok_lch_ab_to_ok_lab(l, c, h, L, a, b);
+        });
+}
+
 // =========== okOK_LAB Space ==========
 
 inline Ok_Lab::Ok_Lab(float l, float a, float b)
@@ -119,30 +493,10 @@ inline Ok_Lch_Ab Ok_Lab::to_ok_lch_ab() const
 }
 
 inline Rgb Ok_Lab::to_rgb() const
-
 {
-    auto normal_gamma = [](float c) {
-        c = std::fmax(0.f, c);
-        float encoded = (c <= 0.0031308f) ? 12.92f * c
-                                          : 1.055f * std::exp2f(std::log2f(c) * 0.41666f) - 0.055f;
-        return encoded * 255.f;
-    };
-
-    auto [L, a, b] = m_values;
-
-    float l_ = L + 0.3963377774f * a + 0.2158037573f * b;
-    float m_ = L - 0.1055613458f * a - 0.0638541728f * b;
-    float s_ = L - 0.0894841775f * a - 1.2914855480f * b;
+    auto [r1, g1, b1] = ok_lab_to_linear_rgb(l(), a(), b());
 
-    float l = l_ * l_ * l_;
-    float m = m_ * m_ * m_;
-    float s = s_ * s_ * s_;
-
-    float r1 = +4.0767416621f * l - 3.3077115913f * m + 0.2309699292f * s;
-    float g1 = -1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s;
-    float b1 = -0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s;
-
-    return { normal_gamma(r1), normal_gamma(g1), normal_gamma(b1) };
+    return { srgb_encode(r1), srgb_encode(g1), srgb_encode(b1) };
 }
 
 inline void Ok_Lab::print() const
@@ -171,6 +525,28 @@ inline void Ok_Lch_Ab::print() const
               << "\nh: " << m_values[2] << "\n\n";
 }
 
+inline Ok_Lch_Hue_Table::Ok_Lch_Hue_Table(float l, float c, int size)
+    : m_linear(size + 1)
+{
+    for (int i = 0; i < size; i++) {
+        auto [L, a, b] = Ok_Lch_Ab(l, c, 360.f * i / size).to_ok_lab().get_values();
+        m_linear[i] = ok_lab_to_linear_rgb(L, a, b);
+    }
+    m_linear[size] = m_linear[0];
+}
+
+inline std::array<float, 3> Ok_Lch_Hue_Table::at(float hue_degrees) const
+{
+    float const x = normalize_degrees(hue_degrees) * (m_linear.size() - 1) / 360.f;
+    size_t const i = std::min(static_cast<size_t>(x), m_linear.size() - 2);
+    float const t = x - i;
+
+    auto const& [r0, g0, b0] = m_linear[i];
+    auto const& [r1, g1, b1] = m_linear[i + 1];
+    return { linear_to_srgb(r0 + t * (r1 - r0)), linear_to_srgb(g0 + t * (g1 - g0)),
+        linear_to_srgb(b0 + t * (b1 - b0)) };
+}
+
 // ========== sRGB Space ==========
 
 inline Rgb::Rgb(float r, float g, float b)
@@ -180,14 +556,9 @@ inline Rgb::Rgb(float r, float g, float b)
 
 inline Ok_Lab Rgb::to_ok_lab() const
 {
-    auto normal_linear = [](float c) {
-        c = std::fmax(0.f, c / 255.f); // normalize and avoid negatives
-        return (c <= 0.04045f) ? c / 12.92f : std::exp2f(std::log2f((c + 0.055f) / 1.055f) * 2.4f);
-    };
-
-    float r_lin = normal_linear(r());
-    float g_lin = normal_linear(g());
-    float b_lin = normal_linear(b());
+    float r_lin = srgb_decode(r());
+    float g_lin = srgb_decode(g());
+    float b_lin = srgb_decode(b());
 
     float l = 0.4122214708f * r_lin + 0.5363325363f * g_lin + 0.0514459929f * b_lin;
     float m = 0.2119034982f * r_lin + 0.6806995451f * g_lin + 0.1073969566f * b_lin;
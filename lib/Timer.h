@@ -1,63 +1,344 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
+// Build with -DPROFILING=0 to compile every PROFILE_* macro out to nothing.
+#ifndef PROFILING
+#define PROFILING 1
+#endif
+
+/// Low-overhead hierarchical profiler.
+///
+/// Each thread appends fixed-size events to its own ring buffer, so recording
+/// takes no lock and allocates nothing; when a buffer fills, the oldest events
+/// are overwritten. A scope is identified by the address of a static Scope at
+/// its call site, so no strings are copied or hashed per event.
+///
+/// Reports group events into frames (see frame()) and give per-frame p50 / p95 /
+/// p99 for every scope and counter. printData() and writeChromeTrace() read the
+/// buffers while other threads may still write to them, so call them while the
+/// instrumented threads are idle.
 class Timer {
-private:
-    inline static size_t const EXPECTED_MAX_DIGITS = 8;
-    inline static size_t maxLabelSize = 0;
-    inline static std::unordered_map<std::string, double> data = {};
-    inline static std::chrono::time_point<std::chrono::high_resolution_clock> m_GlobalStart;
+public:
+    struct Scope {
+        char const* name;
+    };
 
-    std::chrono::time_point<std::chrono::high_resolution_clock> m_StartTimepoint;
-    std::string label;
+    static size_t constexpr BUFFER_CAPACITY = 1 << 15; // events per thread
 
-public:
-    inline Timer(std::string const& label)
-        : m_StartTimepoint(std::chrono::high_resolution_clock::now())
-        , label(label)
+    /// time the enclosing block as one event of scope
+    explicit Timer(Scope const& scope)
+        : m_scope(&scope)
+        , m_begin(now())
+    {
+        threadLog().depth++;
+    }
+
+    ~Timer()
+    {
+        ThreadLog& log = threadLog();
+        log.depth--;
+        log.push({ m_scope, m_begin, now(), 0, log.depth, Kind::Zone });
+    }
+
+    Timer(Timer const&) = delete;
+    Timer& operator=(Timer const&) = delete;
+
+    /// discard everything recorded so far and restart the clock
+    inline static void Start()
     {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        for (auto& log : registry().logs) {
+            log->written.store(0, std::memory_order_relaxed);
+        }
+        epoch() = std::chrono::steady_clock::now();
     }
 
-    inline ~Timer() { Stop(); }
+    /// mark the start of a frame; call once per frame from the main loop
+    inline static void frame()
+    {
+        static Scope const scope { "frame" };
+        int64_t const t = now();
+        threadLog().push({ &scope, t, t, 0, 0, Kind::Frame });
+    }
 
-    inline static void printData()
+    /// record value for scope's counter, e.g. the particle count each frame
+    inline static void counter(Scope const& scope, double value)
     {
-        auto const endTimepoint = std::chrono::high_resolution_clock::now();
-        auto const globalDuration
-            = std::chrono::duration<double, std::milli>(endTimepoint - m_GlobalStart).count();
+        int64_t const t = now();
+        threadLog().push({ &scope, t, t, value, 0, Kind::Counter });
+    }
+
+    /// print every scope, indented by nesting depth, then every counter, with
+    /// total time and per-frame percentiles
+    inline static void printData();
 
-        size_t const borderSize = maxLabelSize + EXPECTED_MAX_DIGITS + 14;
-        std::string const border(borderSize, '-');
+    /// write every buffered event as Chrome trace JSON (chrome://tracing, Perfetto)
+    inline static bool writeChromeTrace(std::string const& path);
 
-        std::cout << border << '\n';
+private:
+    enum class Kind : uint8_t { Zone, Counter, Frame };
+
+    struct Event {
+        Scope const* scope;
+        int64_t begin; // ns since Start()
+        int64_t end;
+        double value;
+        uint32_t depth;
+        Kind kind;
+    };
 
-        for (auto const& pair : data) {
+    struct ThreadLog {
+        std::unique_ptr<Event[]> events { new Event[BUFFER_CAPACITY] };
+        std::atomic<uint64_t> written { 0 };
+        uint32_t depth = 0;
+        unsigned index = 0;
+
+        void push(Event const& event)
+        {
+            uint64_t const n = written.load(std::memory_order_relaxed);
+            events[n % BUFFER_CAPACITY] = event;
+            written.store(n + 1, std::memory_order_release);
+        }
 
-            std::cout << std::left << std::setw(maxLabelSize) << pair.first << ": " << std::right
-                      << std::fixed << std::setw(EXPECTED_MAX_DIGITS) << std::setprecision(3)
-                      << pair.second << " ms | " << std::setprecision(1)
-                      << (pair.second / globalDuration) * 100 << "%\n";
+        /// buffered events, oldest first
+        std::vector<Event> snapshot() const
+        {
+            uint64_t const n = written.load(std::memory_order_acquire);
+            uint64_t const first = n > BUFFER_CAPACITY ? n - BUFFER_CAPACITY : 0;
+            std::vector<Event> out;
+            out.reserve(n - first);
+            for (uint64_t i = first; i < n; i++) {
+                out.push_back(events[i % BUFFER_CAPACITY]);
+            }
+            return out;
         }
-        std::cout << border << std::endl;
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadLog>> logs; // never freed, threads may exit first
+    };
+
+    struct Series {
+        Scope const* scope;
+        Kind kind;
+        uint32_t depth;
+        int64_t firstSeen;
+        double total = 0;
+        std::vector<double> perFrame;
+    };
+
+    Scope const* m_scope;
+    int64_t m_begin;
+
+    inline static Registry& registry()
+    {
+        static Registry instance;
+        return instance;
     }
 
-    inline static void Start() { m_GlobalStart = std::chrono::high_resolution_clock::now(); }
+    inline static std::chrono::steady_clock::time_point& epoch()
+    {
+        static std::chrono::steady_clock::time_point instance = std::chrono::steady_clock::now();
+        return instance;
+    }
 
-private:
-    inline void Stop()
+    inline static int64_t now()
     {
-        auto const endTimepoint = std::chrono::high_resolution_clock::now();
-        auto const duration
-            = std::chrono::duration<double, std::milli>(endTimepoint - m_StartTimepoint).count();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch())
+            .count();
+    }
+
+    inline static ThreadLog& threadLog()
+    {
+        thread_local ThreadLog* log = [] {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            registry().logs.push_back(std::make_unique<ThreadLog>());
+            registry().logs.back()->index = registry().logs.size() - 1;
+            return registry().logs.back().get();
+        }();
+        return *log;
+    }
 
-        if (label.size() > maxLabelSize) {
-            maxLabelSize = label.size();
+    /// every log's snapshot, indexed like registry().logs
+    inline static std::vector<std::vector<Event>> snapshots()
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        std::vector<std::vector<Event>> out;
+        for (auto const& log : registry().logs) {
+            out.push_back(log->snapshot());
         }
+        return out;
+    }
 
-        data[label] += duration;
+    inline static double percentile(std::vector<double> values, double p)
+    {
+        if (values.empty()) {
+            return 0;
+        }
+        size_t const rank = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+        return values[rank];
     }
 };
+
+inline void Timer::printData()
+{
+    std::vector<std::vector<Event>> const logs = snapshots();
+
+    // frames only count once every thread's buffer still covers them
+    std::vector<int64_t> frameStarts;
+    int64_t coveredFrom = 0;
+    for (auto const& events : logs) {
+        if (events.size() == BUFFER_CAPACITY) {
+            coveredFrom = std::max(coveredFrom, events.front().begin);
+        }
+        for (Event const& event : events) {
+            if (event.kind == Kind::Frame) {
+                frameStarts.push_back(event.begin);
+            }
+        }
+    }
+    std::sort(frameStarts.begin(), frameStarts.end());
+    frameStarts.erase(std::remove_if(frameStarts.begin(), frameStarts.end(),
+                          [&](int64_t t) { return t < coveredFrom; }),
+        frameStarts.end());
+
+    std::vector<Series> series;
+    for (auto const& events : logs) {
+        for (Event const& event : events) {
+            if (event.kind == Kind::Frame) {
+                continue;
+            }
+
+            auto found = std::find_if(series.begin(), series.end(),
+                [&](Series const& s) { return s.scope == event.scope; });
+            if (found == series.end()) {
+                series.push_back({ event.scope, event.kind, event.depth, event.begin });
+                series.back().perFrame.assign(frameStarts.size(), 0);
+                found = series.end() - 1;
+            }
+            found->firstSeen = std::min(found->firstSeen, event.begin);
+
+            double const ms = (event.end - event.begin) / 1e6;
+            auto const next = std::upper_bound(frameStarts.begin(), frameStarts.end(), event.begin);
+            bool const inFrame = next != frameStarts.begin();
+            size_t const frame = next - frameStarts.begin() - 1;
+
+            if (event.kind == Kind::Zone) {
+                found->total += ms;
+                if (inFrame) {
+                    found->perFrame[frame] += ms;
+                }
+            } else if (inFrame) {
+                found->perFrame[frame] = event.value; // last sample in the frame
+            }
+        }
+    }
+
+    // zones in the order they first ran, so children follow their parents; counters last
+    std::sort(series.begin(), series.end(), [](Series const& a, Series const& b) {
+        if (a.kind != b.kind) {
+            return a.kind == Kind::Zone;
+        }
+        return a.firstSeen < b.firstSeen;
+    });
+
+    size_t labelSize = 8;
+    for (Series const& s : series) {
+        labelSize = std::max(labelSize, 2 * s.depth + std::string(s.scope->name).size());
+    }
+
+    std::string const border(labelSize + 52, '-');
+    std::cout << border << '\n'
+              << std::left << std::setw(labelSize) << "scope" << std::right << std::setw(13)
+              << "total ms" << std::setw(13) << "p50" << std::setw(13) << "p95"
+              << std::setw(13) << "p99" << '\n'
+              << std::fixed << std::setprecision(3);
+
+    for (Series const& s : series) {
+        std::string const label = std::string(2 * s.depth, ' ') + s.scope->name;
+        std::cout << std::left << std::setw(labelSize) << label << std::right << std::setw(13);
+        if (s.kind == Kind::Zone) {
+            std::cout << s.total;
+        } else {
+            std::cout << "";
+        }
+        std::cout << std::setw(13) << percentile(s.perFrame, 0.50) << std::setw(13)
+                  << percentile(s.perFrame, 0.95) << std::setw(13)
+                  << percentile(s.perFrame, 0.99) << '\n';
+    }
+
+    std::cout << border << '\n'
+              << "per-frame percentiles over " << frameStarts.size() << " frames" << std::endl;
+}
+
+inline bool Timer::writeChromeTrace(std::string const& path)
+{
+    std::vector<std::vector<Event>> const logs = snapshots();
+    std::ofstream file(path);
+
+    file << "{\"traceEvents\":[";
+    bool first = true;
+    for (size_t tid = 0; tid < logs.size(); tid++) {
+        for (Event const& event : logs[tid]) {
+            file << (first ? "\n" : ",\n") << std::fixed << std::setprecision(3);
+            first = false;
+
+            // Chrome trace timestamps are microseconds
+            file << "{\"name\":\"" << event.scope->name << "\",\"pid\":0,\"tid\":" << tid
+                 << ",\"ts\":" << event.begin / 1e3;
+            switch (event.kind) {
+            case Kind::Zone:
+                file << ",\"ph\":\"X\",\"dur\":" << (event.end - event.begin) / 1e3 << "}";
+                break;
+            case Kind::Counter:
+                file << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+                break;
+            case Kind::Frame:
+                file << ",\"ph\":\"i\",\"s\":\"g\"}";
+                break;
+            }
+        }
+    }
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if PROFILING
+/// time the rest of the enclosing block under name, a string literal
+#define PROFILE_SCOPE(name)                                                                        \
+    static Timer::Scope const PROFILE_CONCAT(profileScope_, __LINE__) { name };                    \
+    Timer const PROFILE_CONCAT(profileTimer_, __LINE__)(PROFILE_CONCAT(profileScope_, __LINE__))
+#define PROFILE_COUNTER(name, value)                                                               \
+    do {                                                                                           \
+        static Timer::Scope const profileCounter { name };                                         \
+        Timer::counter(profileCounter, value);                                                     \
+    } while (false)
+#define PROFILE_FRAME() Timer::frame()
+#define PROFILE_START() Timer::Start()
+#define PROFILE_REPORT() Timer::printData()
+#define PROFILE_WRITE_TRACE(path) Timer::writeChromeTrace(path)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_COUNTER(name, value)
+#define PROFILE_FRAME()
+#define PROFILE_START()
+#define PROFILE_REPORT()
+#define PROFILE_WRITE_TRACE(path) false
+#endif
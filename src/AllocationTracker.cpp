@@ -0,0 +1,60 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<size_t> g_allocations { 0 };
+std::atomic<char const*> g_forbiddenPhase { nullptr };
+} // namespace
+
+#ifdef TRACK_ALLOCATIONS
+
+// operator new[] and the nothrow forms forward here by default. Out of line so
+// GCC does not inline free() into callers and flag it as a mismatched delete.
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (char const* phase = g_forbiddenPhase.load(std::memory_order_relaxed)) {
+        // stdio only, anything fancier could allocate again
+        std::fprintf(stderr, "Heap allocation of %zu bytes during %s\n", size, phase);
+        std::abort();
+    }
+
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+bool allocation_tracking_enabled() { return true; }
+
+#else
+
+bool allocation_tracking_enabled() { return false; }
+
+#endif
+
+size_t allocation_count() { return g_allocations.load(std::memory_order_relaxed); }
+
+NoAllocationScope::NoAllocationScope(char const* phase, bool armed)
+    : m_previous(nullptr)
+    , m_armed(armed)
+{
+    if (m_armed) {
+        m_previous = g_forbiddenPhase.exchange(phase);
+    }
+}
+
+NoAllocationScope::~NoAllocationScope()
+{
+    if (m_armed) {
+        g_forbiddenPhase.store(m_previous);
+    }
+}
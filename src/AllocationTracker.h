@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+
+/// Heap allocation accounting through a replaced global operator new.
+/// Only compiled in when TRACK_ALLOCATIONS is defined (the debug and bench
+/// builds); otherwise counts stay 0 and NoAllocationScope does nothing.
+
+/// true when this build counts allocations
+bool allocation_tracking_enabled();
+
+/// allocations made by every thread since startup
+size_t allocation_count();
+
+/// While an armed scope is alive, a heap allocation on any thread prints the
+/// phase and the request size, then aborts, so a debugger stops on the culprit.
+/// Scopes nest; the innermost armed phase is reported.
+class NoAllocationScope {
+public:
+    explicit NoAllocationScope(char const* phase, bool armed = true);
+    ~NoAllocationScope();
+
+    NoAllocationScope(NoAllocationScope const&) = delete;
+    NoAllocationScope& operator=(NoAllocationScope const&) = delete;
+
+private:
+    char const* m_previous;
+    bool m_armed;
+};
@@ -1,30 +1,77 @@
 #include "Engine.h"
-#include "Particle.h"
+#include "AllocationTracker.h"
+#include "ParticleSystem.h"
+#include "RenderBackend.h"
+#include "../lib/Timer.h"
 #include "config.h"
 #include "util.h"
 
 #include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cmath>
 
-Engine::Engine()
-    : m_particleAccumulator(0.f)
+Engine::Engine(Config const& config, bool headless)
+    : m_config(config)
+    , m_particleAccumulator(0.f)
+    , m_threadPool(config.threadCount)
     , m_currColorIdx(0)
-    , m_colors(get_rainbow_colors(PARTICLES_PER_SECOND * SECONDS_PER_RAINBOW_CYCLE))
+    , m_colors(get_rainbow_colors(static_cast<int>(config.paletteSize())))
 
 {
-    m_window.create(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), WINDOW_TITLE);
+    setViewport(sf::Vector2u(config.windowWidth, config.windowHeight));
+    // config's scale is per frame at the target rate; the closed form wants it per second
+    m_particles.setPhysics(
+        { config.gravity, config.ttl, std::pow(config.scale, float(config.targetFps)) });
+    m_particles.setThreadPool(&m_threadPool);
+    using RemovalPolicy = ParticleSystem::RemovalPolicy;
+    m_particles.setRemovalPolicy(
+        config.removalPolicy == "swap" ? RemovalPolicy::SwapAndPop : RemovalPolicy::Stable);
+    m_particles.reserve(config.poolSize());
+    m_particles.preparePalette(m_colors.data(), m_colors.size());
+    m_interactions.setSettings({ config.interactionRadius, config.interactionCell, config.repulsion,
+        config.cohesion, config.collideEdges, config.restitution });
+    m_interactions.setThreadPool(&m_threadPool);
+    for (ForceSource const& source : config.forces) {
+        m_forceField.add(source);
+    }
+    m_forceField.setCellSize(config.fieldCell);
+    m_interactions.setForceField(&m_forceField);
+
+    if (headless) {
+        m_renderer = make_render_backend(config.renderer, nullptr, m_threadPool);
+        return;
+    }
+
+    m_window.create(sf::VideoMode(config.windowWidth, config.windowHeight), config.windowTitle);
 
     if (!m_window.isOpen()) {
         throw std::runtime_error("Failed to create SFML window");
     }
 
     auto desktop = sf::VideoMode::getDesktopMode();
-    m_window.setPosition({ static_cast<int>(desktop.width / 2 - WINDOW_WIDTH / 2),
-        static_cast<int>(desktop.height / 2 - WINDOW_HEIGHT / 2) });
+    m_window.setPosition({ static_cast<int>(desktop.width / 2 - config.windowWidth / 2),
+        static_cast<int>(desktop.height / 2 - config.windowHeight / 2) });
 
-    m_window.setFramerateLimit(TARGET_FPS);
+    m_window.setFramerateLimit(config.targetFps);
+    m_renderer = make_render_backend(config.renderer, &m_window, m_threadPool);
 }
 
 void Engine::input(float dtAsSeconds)
+{
+    PROFILE_SCOPE("input");
+    [[maybe_unused]] size_t const allocations = allocation_count();
+
+    InputFrame const frame = pollInput(dtAsSeconds);
+
+    if (!m_recordPath.empty()) {
+        m_recording.frames.push_back(frame);
+    }
+
+    applyInput(frame);
+    PROFILE_COUNTER("input allocations", allocation_count() - allocations);
+}
+
+InputFrame Engine::pollInput(float dtAsSeconds)
 {
     Event event;
 
@@ -44,42 +91,111 @@ void Engine::input(float dtAsSeconds)
     }
 
     sf::Vector2i const mousePos = sf::Mouse::getPosition(m_window);
-    bool const mouseLeftPressed = sf::Mouse::isButtonPressed(sf::Mouse::Left);
+    sf::Vector2u const windowSize = m_window.getSize();
 
-    if (mouseLeftPressed) {
-        m_particleAccumulator += PARTICLES_PER_SECOND * dtAsSeconds;
+    InputFrame frame;
+    frame.dtAsSeconds = dtAsSeconds;
+    frame.mouseX = mousePos.x;
+    frame.mouseY = mousePos.y;
+    frame.viewportWidth = windowSize.x;
+    frame.viewportHeight = windowSize.y;
+    frame.mouseLeftPressed = sf::Mouse::isButtonPressed(sf::Mouse::Left);
+    return frame;
+}
 
-        while (m_particleAccumulator >= 1.f) {
-            m_particles.emplace_back(Particle(m_window, m_colors[m_currColorIdx], mousePos));
-            m_currColorIdx = (m_currColorIdx + 1) % m_colors.size();
-            m_particleAccumulator -= 1.f;
-        }
+void Engine::applyInput(InputFrame const& frame)
+{
+    sf::Vector2u const viewportSize(frame.viewportWidth, frame.viewportHeight);
+
+    if (viewportSize != m_viewportSize) {
+        setViewport(viewportSize);
+    }
+
+    if (frame.mouseLeftPressed) {
+        emit(frame.dtAsSeconds, { frame.mouseX, frame.mouseY });
     } else {
         m_particleAccumulator = 0.f; // reset if mouse not held
     }
 }
 
+void Engine::setViewport(sf::Vector2u size)
+{
+    m_cartesianToScreen
+        = sf::Transform(1.f, 0.f, size.x / 2.f, 0.f, -1.f, size.y / 2.f, 0.f, 0.f, 1.f);
+    m_screenToCartesian = m_cartesianToScreen.getInverse();
+    m_viewportSize = size;
+}
+
+void Engine::emit(float dtAsSeconds, Vector2i emitterPosition)
+{
+    Vector2f const center = m_screenToCartesian.transformPoint(Vector2f(emitterPosition));
+
+    m_particleAccumulator += m_config.particlesPerSecond * dtAsSeconds;
+
+    size_t const count = static_cast<size_t>(m_particleAccumulator);
+    if (count == 0) {
+        return;
+    }
+
+    m_particles.spawn(count, center, m_colors.data(), m_colors.size(), m_currColorIdx);
+    m_currColorIdx = (m_currColorIdx + count) % m_colors.size();
+    m_particleAccumulator -= count;
+}
+
 void Engine::update(float dtAsSeconds)
 {
-    std::vector<Particle>::iterator it = m_particles.begin();
+    PROFILE_SCOPE("update");
+    [[maybe_unused]] size_t const allocations = allocation_count();
+    {
+        NoAllocationScope const guard("update", allocationsForbidden());
+        m_particles.removeDead();
+        m_particles.update(dtAsSeconds);
 
-    while (it != m_particles.end()) {
-        if (it->getTTL() > 0.0) {
-            it->update(m_window, dtAsSeconds);
-            ++it;
-        } else {
-            it = m_particles.erase(it);
+        if (m_interactions.enabled()) {
+            PROFILE_SCOPE("interact");
+            // the window in world space: the Cartesian plane is centered on it
+            sf::FloatRect const bounds(-m_viewportSize.x / 2.f, -m_viewportSize.y / 2.f,
+                m_viewportSize.x, m_viewportSize.y);
+            if (!m_forceField.empty()) {
+                PROFILE_SCOPE("bake");
+                m_forceField.bake(bounds, m_particles.getTime());
+            }
+            m_interactions.step(m_particles, dtAsSeconds, bounds);
         }
     }
+    PROFILE_COUNTER("update allocations", allocation_count() - allocations);
 }
 
 void Engine::draw()
 {
-    m_window.clear();
-    for (auto particle : m_particles) {
-        m_window.draw(particle);
+    PROFILE_SCOPE("draw");
+    [[maybe_unused]] size_t const allocations = allocation_count();
+    {
+        NoAllocationScope const guard("draw", allocationsForbidden());
+        m_renderer->beginFrame(m_viewportSize);
+        m_renderer->drawParticles(m_particles, m_cartesianToScreen);
+        m_renderer->endFrame();
+
+        if (m_exporter) {
+            PROFILE_SCOPE("export");
+            m_exporter->submit(*m_renderer->getFramebuffer());
+        }
     }
-    m_window.display();
+    PROFILE_COUNTER("draw allocations", allocation_count() - allocations);
+}
+
+void Engine::exportFrames(std::string const& path)
+{
+    if (!m_renderer || !m_renderer->getFramebuffer()) {
+        throw std::runtime_error("Error: exporting frames needs renderer = cpu");
+    }
+    m_exporter = std::make_unique<FrameExporter>(path, m_config.targetFps, m_config.exportQueue);
+}
+
+bool Engine::allocationsForbidden() const
+{
+    return m_forbidAllocations
+        && m_frameCount > static_cast<size_t>(ALLOCATION_WARMUP_SECONDS * m_config.targetFps);
 }
 
 void Engine::run()
@@ -88,17 +204,154 @@ void Engine::run()
 
     // TESTS
     std::cout << "Starting Particle unit tests..." << std::endl;
-    Particle p(m_window, sf::Color(0, 255, 255),
-        { (int)m_window.getSize().x / 2, (int)m_window.getSize().y / 2 });
+    Vector2f const windowCenter(m_window.getSize().x / 2, m_window.getSize().y / 2);
+    Particle p = m_particles.spawn(
+        sf::Color(0, 255, 255), m_screenToCartesian.transformPoint(windowCenter));
     p.unitTests();
+    m_particles.clear();
     std::cout << "Unit tests complete.  Starting engine..." << std::endl;
 
+    if (!m_recordPath.empty()) {
+        // restart the random streams so the recording replays from a known state
+        seed_random(get_random_seed());
+        m_recording.seed = get_random_seed();
+        m_recording.frames.clear();
+    }
+
     // ENGINE
+    m_frameCount = 0;
+    PROFILE_START();
     while (m_window.isOpen()) {
+        PROFILE_FRAME();
+        [[maybe_unused]] size_t const allocations = allocation_count();
         float const dtAsSeconds = frameClock.restart().asSeconds();
 
         input(dtAsSeconds);
         update(dtAsSeconds);
         draw();
+        m_frameCount++;
+        PROFILE_COUNTER("particles", m_particles.size());
+        PROFILE_COUNTER("frame allocations", allocation_count() - allocations);
+    }
+
+    PROFILE_REPORT();
+    writeTrace();
+    finishExport();
+
+    if (!m_recordPath.empty()) {
+        m_recording.save(m_recordPath);
+        std::cout << "Recorded " << m_recording.frames.size() << " frames to " << m_recordPath
+                  << std::endl;
+    }
+}
+
+void Engine::runHeadless(int frames)
+{
+    int const width = m_config.windowWidth;
+    int const height = m_config.windowHeight;
+    float const dtAsSeconds = 1.f / m_config.targetFps;
+    float const emitterRadius = std::min(width, height) / 4.f;
+
+    std::cout << "Running " << frames << " headless frames at dt = " << dtAsSeconds << "s"
+              << std::endl;
+
+    InputRecording script;
+    script.seed = get_random_seed();
+    script.frames.reserve(frames);
+
+    for (int frame = 0; frame < frames; frame++) {
+        // emitter circles the window center once every rainbow cycle
+        float const angle = 2 * M_PI * frame * dtAsSeconds / m_config.secondsPerRainbowCycle;
+
+        InputFrame input;
+        input.dtAsSeconds = dtAsSeconds;
+        input.mouseX = static_cast<int>(width / 2 + emitterRadius * std::cos(angle));
+        input.mouseY = static_cast<int>(height / 2 + emitterRadius * std::sin(angle));
+        input.viewportWidth = width;
+        input.viewportHeight = height;
+        input.mouseLeftPressed = true;
+        script.frames.push_back(input);
+    }
+
+    replay(script);
+}
+
+void Engine::replay(InputRecording const& recording)
+{
+    size_t peakParticles = 0;
+
+    seed_random(recording.seed);
+    m_frameCount = 0;
+    std::cout << "Replaying " << recording.frames.size() << " frames on " << m_threadPool.size()
+              << " thread(s)..." << std::endl;
+
+    PROFILE_START();
+    auto const start = std::chrono::steady_clock::now();
+
+    for (InputFrame const& frame : recording.frames) {
+        PROFILE_FRAME();
+        [[maybe_unused]] size_t const allocations = allocation_count();
+        {
+            PROFILE_SCOPE("input");
+            applyInput(frame);
+            PROFILE_COUNTER("input allocations", allocation_count() - allocations);
+        }
+        update(frame.dtAsSeconds);
+        if (m_renderer) {
+            draw();
+        } else {
+            // nothing to draw into, but build the vertices so timings cover them
+            PROFILE_SCOPE("draw");
+            NoAllocationScope const guard("draw", allocationsForbidden());
+            m_particles.buildBatch();
+        }
+        m_frameCount++;
+        PROFILE_COUNTER("particles", m_particles.size());
+        PROFILE_COUNTER("frame allocations", allocation_count() - allocations);
+
+        peakParticles = std::max(peakParticles, m_particles.size());
+    }
+
+    double const elapsedMs
+        = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+              .count();
+
+    PROFILE_REPORT();
+    std::cout << "Total: " << elapsedMs << " ms, "
+              << elapsedMs / std::max<size_t>(recording.frames.size(), 1) << " ms per frame"
+              << std::endl;
+    std::cout << "Peak particles: " << peakParticles << std::endl;
+    std::cout << "Seed: " << recording.seed << std::endl;
+    writeTrace();
+    finishExport();
+}
+
+void Engine::writeTrace()
+{
+    if (m_tracePath.empty()) {
+        return;
+    }
+
+    if (PROFILE_WRITE_TRACE(m_tracePath)) {
+        std::cout << "Wrote Chrome trace to " << m_tracePath << std::endl;
+    } else {
+        std::cout << "Failed to write trace to " << m_tracePath
+                  << " (profiling needs PROFILING=1)" << std::endl;
+    }
+}
+
+void Engine::finishExport()
+{
+    if (!m_exporter) {
+        return;
+    }
+
+    m_exporter->finish();
+    std::cout << "Exported " << m_exporter->getFramesWritten() << " frames to "
+              << m_exporter->getPath();
+    if (m_exporter->getFramesSkipped() > 0) {
+        std::cout << " (skipped " << m_exporter->getFramesSkipped()
+                  << " resized frames, every frame takes the first one's size)";
     }
+    std::cout << std::endl;
 }
@@ -1,23 +1,100 @@
 #pragma once
-#include "Particle.h"
+#include "InputRecording.h"
+#include "ParticleInteractions.h"
+#include "FrameExporter.h"
+#include "ParticleSystem.h"
+#include "RenderBackend.h"
+#include "config.h"
 #include <SFML/Graphics.hpp>
+#include <string>
 
 class Engine {
 public:
-    Engine();
+    /// headless skips window creation; only runHeadless() and replay() may be used then
+    explicit Engine(Config const& config, bool headless = false);
     void run();
 
+    /// save the input of the next run() to path when its window closes
+    void record(std::string const& path) { m_recordPath = path; }
+
+    /// write the profiler's events as Chrome trace JSON to path once a run finishes
+    void trace(std::string const& path) { m_tracePath = path; }
+
+    /// forces acting on every particle, set up from the config; sources may be added
+    /// or removed between frames
+    ForceField& getForceField() { return m_forceField; }
+
+    /// write every frame drawn from now on to path, as a .y4m video or numbered .ppm
+    /// images (see FrameExporter); throws std::runtime_error unless renderer is cpu
+    void exportFrames(std::string const& path);
+
+    /// abort on any heap allocation in update() or draw() once the first
+    /// ALLOCATION_WARMUP_SECONDS of frames have filled the pools; needs TRACK_ALLOCATIONS
+    void forbidAllocations(bool forbid) { m_forbidAllocations = forbid; }
+
+    /// step the simulation for frames frames at a fixed dt of 1 / targetFps,
+    /// spawning from a scripted emitter path, then print per-phase timing
+    void runHeadless(int frames);
+
+    /// step the simulation through every recorded frame without a window, then print
+    /// per-phase timing; frames are rendered if the renderer works headless (cpu),
+    /// otherwise vertices are still built, as they are the per-particle work
+    void replay(InputRecording const& recording);
+
 private:
+    // long enough for the population, and every buffer sized by it, to peak
+    static int constexpr ALLOCATION_WARMUP_SECONDS = 3;
+
+    Config const m_config;
     sf::RenderWindow m_window;
 
+    // particles live on a Cartesian plane centered in the window, y up;
+    // these map it to and from window pixels and change only on resize
+    sf::Transform m_cartesianToScreen;
+    sf::Transform m_screenToCartesian;
+    sf::Vector2u m_viewportSize;
+
     float m_particleAccumulator;
-    std::vector<Particle> m_particles;
+    ParticleSystem m_particles;
+    ThreadPool m_threadPool;
+    ParticleInteractions m_interactions;
+    ForceField m_forceField;
+    std::unique_ptr<RenderBackend> m_renderer; // null if there is nothing to draw into
 
     size_t m_currColorIdx;
     std::vector<sf::Color> m_colors;
 
+    std::string m_recordPath; // empty unless record() was called
+    InputRecording m_recording;
+    std::string m_tracePath; // empty unless trace() was called
+    std::unique_ptr<FrameExporter> m_exporter; // null unless exportFrames() was called
+
+    size_t m_frameCount = 0; // frames stepped in the current run
+    bool m_forbidAllocations = false;
+
     // Private functions for internal use only
     void input(float dtAsSeconds);
+
+    /// handle window events and sample the mouse for this frame
+    InputFrame pollInput(float dtAsSeconds);
+
+    /// act on one frame of input, live or replayed
+    void applyInput(InputFrame const& frame);
+
     void update(float dtAsSeconds);
     void draw();
+
+    /// recompute the Cartesian plane transforms for a window of this size
+    void setViewport(sf::Vector2u size);
+
+    /// spawn particles at emitterPosition for dtAsSeconds worth of particlesPerSecond
+    void emit(float dtAsSeconds, Vector2i emitterPosition);
+
+    /// write the Chrome trace if trace() was called
+    void writeTrace();
+
+    /// flush the exported frames if exportFrames() was called
+    void finishExport();
+
+    bool allocationsForbidden() const;
 };
@@ -0,0 +1,34 @@
+#include "FadeTable.h"
+#include "util.h"
+
+uint32_t FadeTable::row(sf::Color color)
+{
+    uint32_t const key = (uint32_t(color.r) << 24) | (uint32_t(color.g) << 16)
+        | (uint32_t(color.b) << 8) | color.a;
+
+    auto const found = m_rows.find(key);
+    if (found != m_rows.end()) {
+        return found->second;
+    }
+
+    auto const [L, a, b] = clrspc::Rgb(color.r, color.g, color.b).to_ok_lab().get_values();
+
+    float labL[STEPS], labA[STEPS], labB[STEPS];
+    for (int k = 0; k < STEPS; k++) {
+        float const remaining = 1.f - static_cast<float>(k) / (STEPS - 1);
+        labL[k] = L * remaining;
+        labA[k] = a * remaining;
+        labB[k] = b * remaining;
+    }
+
+    float red[STEPS], green[STEPS], blue[STEPS];
+    clrspc::ok_lab_to_rgb(labL, labA, labB, red, green, blue, STEPS);
+
+    uint32_t const row = m_rows.size();
+    for (int k = 0; k < STEPS; k++) {
+        m_colors.emplace_back(to_u8(red[k]), to_u8(green[k]), to_u8(blue[k]), color.a);
+    }
+
+    m_rows.emplace(key, row);
+    return row;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/// Fade-to-black gradients computed in OkLab, one row of STEPS colors per base color.
+/// Step k is the base color with every OkLab coordinate scaled by 1 - k / (STEPS - 1):
+/// lightness falls evenly to black while the hue holds, unlike subtracting a fixed
+/// amount from each sRGB channel. Rows are built the first time a color is seen.
+class FadeTable {
+public:
+    static int constexpr STEPS = 64;
+
+    /// row of the gradient that starts at color
+    uint32_t row(sf::Color color);
+
+    /// color of row at age, 0 (just spawned) to 1 (expired)
+    sf::Color at(uint32_t row, float age) const
+    {
+        int const step = static_cast<int>(std::min(std::max(age, 0.f), 1.f) * (STEPS - 1) + 0.5f);
+        return m_colors[row * STEPS + step];
+    }
+
+private:
+    std::vector<sf::Color> m_colors; // STEPS entries per row
+    std::unordered_map<uint32_t, uint32_t> m_rows; // packed rgba -> row
+};
@@ -0,0 +1,309 @@
+#include "ForceField.h"
+#include "TransformKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define FORCE_FIELD_X86
+#    include <immintrin.h>
+#endif
+
+namespace {
+
+float constexpr TURBULENCE_DRIFT = 0.5f; // noise periods per second the turbulence evolves by
+
+/// 1 / (1 + (d / radius)^2): full strength up close, fading like gravity far away
+float falloff(float distance, float radius)
+{
+    float const q = distance / radius;
+    return 1 / (1 + q * q);
+}
+
+/// pseudo-random value in [-1, 1] for a lattice point
+float lattice(int x, int y, int z, uint32_t seed)
+{
+    uint32_t h = seed ^ (uint32_t(x) * 0x8da6b343u) ^ (uint32_t(y) * 0xd8163841u)
+        ^ (uint32_t(z) * 0xcb1ab31fu);
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h * (2.f / 4294967295.f) - 1;
+}
+
+float smooth(float t) { return t * t * (3 - 2 * t); }
+float lerp(float a, float b, float t) { return a + (b - a) * t; }
+
+/// value noise: lattice values blended smoothly between integer coordinates
+float value_noise(float x, float y, float z, uint32_t seed)
+{
+    float const fx = std::floor(x), fy = std::floor(y), fz = std::floor(z);
+    int const ix = int(fx), iy = int(fy), iz = int(fz);
+    float const tx = smooth(x - fx), ty = smooth(y - fy), tz = smooth(z - fz);
+
+    float layers[2];
+    for (int k = 0; k < 2; k++) {
+        float const bottom
+            = lerp(lattice(ix, iy, iz + k, seed), lattice(ix + 1, iy, iz + k, seed), tx);
+        float const top
+            = lerp(lattice(ix, iy + 1, iz + k, seed), lattice(ix + 1, iy + 1, iz + k, seed), tx);
+        layers[k] = lerp(bottom, top, ty);
+    }
+    return lerp(layers[0], layers[1], tz);
+}
+
+/// the curl of a noise potential: a swirling, divergence-free field that stirs
+/// particles around without bunching them into sinks
+sf::Vector2f curl_noise(float x, float y, float z, uint32_t seed)
+{
+    float constexpr E = 0.01f;
+    float const dx = value_noise(x + E, y, z, seed) - value_noise(x - E, y, z, seed);
+    float const dy = value_noise(x, y + E, z, seed) - value_noise(x, y - E, z, seed);
+    return { dy / (2 * E), -dx / (2 * E) };
+}
+
+/// where a coordinate falls between grid nodes: node index and the weight of the next
+struct GridCoordinate {
+    int index;
+    float t;
+};
+
+GridCoordinate grid_coordinate(float v, float origin, float inverseCell, int nodes)
+{
+    float const g = std::clamp((v - origin) * inverseCell, 0.f, float(nodes - 1));
+    int const index = std::min(static_cast<int>(g), nodes - 2);
+    return { index, g - index };
+}
+
+} // namespace
+
+ForceSource ForceSource::attractor(sf::Vector2f position, float strength, float radius)
+{
+    ForceSource source;
+    source.kind = Kind::Attractor;
+    source.position = position;
+    source.strength = strength;
+    source.radius = radius;
+    return source;
+}
+
+ForceSource ForceSource::vortex(sf::Vector2f position, float strength, float radius)
+{
+    ForceSource source = attractor(position, strength, radius);
+    source.kind = Kind::Vortex;
+    return source;
+}
+
+ForceSource ForceSource::wind(sf::Vector2f acceleration)
+{
+    ForceSource source;
+    source.kind = Kind::Wind;
+    source.strength = std::hypot(acceleration.x, acceleration.y);
+    if (source.strength > 0) {
+        source.direction = acceleration / source.strength;
+    }
+    return source;
+}
+
+ForceSource ForceSource::turbulence(float strength, float wavelength, uint32_t seed)
+{
+    ForceSource source;
+    source.kind = Kind::Turbulence;
+    source.strength = strength;
+    source.radius = wavelength;
+    source.seed = seed;
+    return source;
+}
+
+sf::Vector2f ForceSource::at(sf::Vector2f point, double time) const
+{
+    switch (kind) {
+    case Kind::Attractor:
+    case Kind::Vortex: {
+        sf::Vector2f const toward = position - point;
+        float const distance = std::hypot(toward.x, toward.y);
+        if (distance == 0) {
+            return {};
+        }
+        float const scale = strength * falloff(distance, radius) / distance;
+        // y is up, so turning toward 90 degrees clockwise of inward circles counterclockwise
+        return kind == Kind::Attractor ? toward * scale : sf::Vector2f(toward.y, -toward.x) * scale;
+    }
+    case Kind::Wind:
+        return direction * strength;
+    case Kind::Turbulence:
+        return strength
+            * curl_noise(point.x / radius, point.y / radius,
+                static_cast<float>(std::fmod(time * TURBULENCE_DRIFT, 65536.0)), seed);
+    }
+    return {};
+}
+
+void ForceField::add(ForceSource const& source)
+{
+    m_sources.push_back(source);
+    m_animated = m_animated || source.kind == ForceSource::Kind::Turbulence;
+    m_dirty = true;
+}
+
+void ForceField::clear()
+{
+    m_sources.clear();
+    m_animated = false;
+    m_dirty = true;
+}
+
+sf::Vector2f ForceField::evaluate(sf::Vector2f point, double time) const
+{
+    sf::Vector2f sum;
+    for (ForceSource const& source : m_sources) {
+        sum += source.at(point, time);
+    }
+    return sum;
+}
+
+void ForceField::bake(sf::FloatRect const& bounds, double time)
+{
+    if (!m_dirty && !m_animated && bounds == m_bounds) {
+        return;
+    }
+
+    m_bounds = bounds;
+    m_columns = std::max(2, static_cast<int>(std::ceil(bounds.width / m_cellSize)) + 1);
+    m_rows = std::max(2, static_cast<int>(std::ceil(bounds.height / m_cellSize)) + 1);
+    m_ax.resize(size_t(m_columns) * m_rows);
+    m_ay.resize(m_ax.size());
+
+    for (int j = 0; j < m_rows; j++) {
+        for (int i = 0; i < m_columns; i++) {
+            sf::Vector2f const a = evaluate(
+                { bounds.left + i * m_cellSize, bounds.top + j * m_cellSize }, time);
+            m_ax[size_t(j) * m_columns + i] = a.x;
+            m_ay[size_t(j) * m_columns + i] = a.y;
+        }
+    }
+    m_dirty = false;
+}
+
+sf::Vector2f ForceField::sample(sf::Vector2f point) const
+{
+    // NaN passes through std::clamp, and converting it to an index is undefined
+    if (m_ax.empty() || !std::isfinite(point.x) || !std::isfinite(point.y)) {
+        return {};
+    }
+
+    float const inverseCell = 1 / m_cellSize;
+    GridCoordinate const x = grid_coordinate(point.x, m_bounds.left, inverseCell, m_columns);
+    GridCoordinate const y = grid_coordinate(point.y, m_bounds.top, inverseCell, m_rows);
+    size_t const node = size_t(y.index) * m_columns + x.index;
+
+    auto const bilinear = [&](std::vector<float> const& a) {
+        return lerp(lerp(a[node], a[node + 1], x.t),
+            lerp(a[node + m_columns], a[node + m_columns + 1], x.t), y.t);
+    };
+    return { bilinear(m_ax), bilinear(m_ay) };
+}
+
+#ifdef FORCE_FIELD_X86
+namespace {
+
+struct Grid {
+    float const* ax;
+    float const* ay;
+    float left;
+    float bottom;
+    float inverseCell;
+    int columns;
+    int rows;
+};
+
+__attribute__((target("avx2"))) inline __m256 clamp8(__m256 v, __m256 low, __m256 high)
+{
+    return _mm256_min_ps(_mm256_max_ps(v, low), high);
+}
+
+__attribute__((target("avx2"))) inline __m256 lerp8(__m256 a, __m256 b, __m256 t)
+{
+    return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t));
+}
+
+// sample() for 8 points at a time: the node indices and weights are computed in
+// lanes and the four corners of each cell gathered, for both components
+__attribute__((target("avx2"))) size_t accelerate_avx2(Grid const& grid, float const* xs,
+    float const* ys, float* vxs, float* vys, size_t n, float dt)
+{
+    __m256 const left = _mm256_set1_ps(grid.left);
+    __m256 const bottom = _mm256_set1_ps(grid.bottom);
+    __m256 const inverseCell = _mm256_set1_ps(grid.inverseCell);
+    __m256 const zero = _mm256_setzero_ps();
+    __m256 const maxX = _mm256_set1_ps(float(grid.columns - 1));
+    __m256 const maxY = _mm256_set1_ps(float(grid.rows - 1));
+    __m256i const lastCellX = _mm256_set1_epi32(grid.columns - 2);
+    __m256i const lastCellY = _mm256_set1_epi32(grid.rows - 2);
+    __m256i const columns = _mm256_set1_epi32(grid.columns);
+    __m256i const one = _mm256_set1_epi32(1);
+    __m256 const step = _mm256_set1_ps(dt);
+
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256 const x = _mm256_loadu_ps(xs + j);
+        __m256 const y = _mm256_loadu_ps(ys + j);
+        // like sample(), no force at a non-finite point: v - v is 0 only for finite v
+        __m256 const finite = _mm256_and_ps(_mm256_cmp_ps(_mm256_sub_ps(x, x), zero, _CMP_EQ_OQ),
+            _mm256_cmp_ps(_mm256_sub_ps(y, y), zero, _CMP_EQ_OQ));
+        __m256 const dts = _mm256_and_ps(step, finite);
+        // max_ps returns its second operand for a NaN lane, so the indices stay in range
+        __m256 const gx = clamp8(_mm256_mul_ps(_mm256_sub_ps(x, left), inverseCell), zero, maxX);
+        __m256 const gy = clamp8(_mm256_mul_ps(_mm256_sub_ps(y, bottom), inverseCell), zero, maxY);
+        __m256i const ix = _mm256_min_epi32(_mm256_cvttps_epi32(gx), lastCellX);
+        __m256i const iy = _mm256_min_epi32(_mm256_cvttps_epi32(gy), lastCellY);
+        __m256 const tx = _mm256_sub_ps(gx, _mm256_cvtepi32_ps(ix));
+        __m256 const ty = _mm256_sub_ps(gy, _mm256_cvtepi32_ps(iy));
+
+        __m256i const n00 = _mm256_add_epi32(_mm256_mullo_epi32(iy, columns), ix);
+        __m256i const n10 = _mm256_add_epi32(n00, one);
+        __m256i const n01 = _mm256_add_epi32(n00, columns);
+        __m256i const n11 = _mm256_add_epi32(n01, one);
+
+        __m256 const ax = lerp8(lerp8(_mm256_i32gather_ps(grid.ax, n00, 4),
+                                    _mm256_i32gather_ps(grid.ax, n10, 4), tx),
+            lerp8(_mm256_i32gather_ps(grid.ax, n01, 4), _mm256_i32gather_ps(grid.ax, n11, 4), tx),
+            ty);
+        __m256 const ay = lerp8(lerp8(_mm256_i32gather_ps(grid.ay, n00, 4),
+                                    _mm256_i32gather_ps(grid.ay, n10, 4), tx),
+            lerp8(_mm256_i32gather_ps(grid.ay, n01, 4), _mm256_i32gather_ps(grid.ay, n11, 4), tx),
+            ty);
+
+        _mm256_storeu_ps(vxs + j, _mm256_add_ps(_mm256_loadu_ps(vxs + j), _mm256_mul_ps(ax, dts)));
+        _mm256_storeu_ps(vys + j, _mm256_add_ps(_mm256_loadu_ps(vys + j), _mm256_mul_ps(ay, dts)));
+    }
+    return j;
+}
+
+} // namespace
+#endif
+
+void ForceField::accelerate(float const* xs, float const* ys, float* vxs, float* vys, size_t n,
+    float dt) const
+{
+    if (m_ax.empty()) {
+        return;
+    }
+
+    size_t first = 0;
+#ifdef FORCE_FIELD_X86
+    if (Matrices::get_simd_level() >= Matrices::SimdLevel::Avx2) {
+        Grid const grid { m_ax.data(), m_ay.data(), m_bounds.left, m_bounds.top, 1 / m_cellSize,
+            m_columns, m_rows };
+        first = accelerate_avx2(grid, xs, ys, vxs, vys, n, dt);
+    }
+#endif
+
+    for (size_t i = first; i < n; i++) {
+        sf::Vector2f const a = sample({ xs[i], ys[i] });
+        vxs[i] += a.x * dt;
+        vys[i] += a.y * dt;
+    }
+}
@@ -0,0 +1,340 @@
+#include "FrameExporter.h"
+#include "TransformKernel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define YUV_KERNEL_X86
+#    include <immintrin.h>
+#endif
+
+namespace {
+
+// BT.601 limited range in 8-bit fixed point, the coefficients every encoder assumes
+// for Y4M without a colorspace tag. Chroma takes the sums of 2x2 blocks (up to 4 * 255),
+// so its shift is two bits wider to average them.
+int luma(int r, int g, int b) { return ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16; }
+int chroma_u(int r4, int g4, int b4) { return ((-38 * r4 - 74 * g4 + 112 * b4 + 512) >> 10) + 128; }
+int chroma_v(int r4, int g4, int b4) { return ((112 * r4 - 94 * g4 - 18 * b4 + 512) >> 10) + 128; }
+
+/// a pair of image rows and the output rows they produce; an odd image's last
+/// pair repeats its one row, writing the same luma twice
+struct RowPair {
+    uint8_t const* rgba0;
+    uint8_t const* rgba1;
+    uint8_t* y0;
+    uint8_t* y1;
+    uint8_t* u;
+    uint8_t* v;
+    unsigned width;
+};
+
+/// convert 2x2 blocks [first, ceil(width / 2)); an odd row's last block repeats its column
+void yuv_blocks_scalar(RowPair const& rows, unsigned first)
+{
+    for (unsigned block = first; block < (rows.width + 1) / 2; block++) {
+        unsigned const x[2] = { 2 * block, std::min(2 * block + 1, rows.width - 1) };
+        int sums[3] = { 0, 0, 0 };
+
+        for (unsigned i : x) {
+            for (int row = 0; row < 2; row++) {
+                uint8_t const* p = (row ? rows.rgba1 : rows.rgba0) + 4 * i;
+                (row ? rows.y1 : rows.y0)[i] = static_cast<uint8_t>(luma(p[0], p[1], p[2]));
+                for (int k = 0; k < 3; k++) {
+                    sums[k] += p[k];
+                }
+            }
+        }
+
+        rows.u[block] = static_cast<uint8_t>(chroma_u(sums[0], sums[1], sums[2]));
+        rows.v[block] = static_cast<uint8_t>(chroma_v(sums[0], sums[1], sums[2]));
+    }
+}
+
+void yuv_rows_scalar(RowPair const& rows) { yuv_blocks_scalar(rows, 0); }
+
+#ifdef YUV_KERNEL_X86
+
+// madd leaves each pixel's dot product split over two 32-bit lanes, (r, g) and (b, a);
+// add the pairs of a (pixels 0, 1) and b (pixels 2, 3) into one lane per pixel
+__attribute__((target("sse2"))) inline __m128i add_lane_pairs(__m128i a, __m128i b)
+{
+    __m128 const fa = _mm_castsi128_ps(a);
+    __m128 const fb = _mm_castsi128_ps(b);
+    return _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0))),
+        _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1))));
+}
+
+// (c * 4 pixels + round) >> shift + offset, for 16-bit pixels (p0, p1) and (p2, p3)
+__attribute__((target("sse2"))) inline __m128i dot4(
+    __m128i p01, __m128i p23, __m128i c, int round, int shift, int offset)
+{
+    __m128i const sum = add_lane_pairs(_mm_madd_epi16(p01, c), _mm_madd_epi16(p23, c));
+    __m128i const shifted = _mm_sra_epi32(
+        _mm_add_epi32(sum, _mm_set1_epi32(round)), _mm_cvtsi32_si128(shift));
+    return _mm_add_epi32(shifted, _mm_set1_epi32(offset));
+}
+
+// luma of 8 RGBA pixels, as bytes in the low half
+__attribute__((target("sse2"))) inline __m128i luma8(__m128i px0123, __m128i px4567)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const c = _mm_setr_epi16(66, 129, 25, 0, 66, 129, 25, 0);
+    __m128i const lo = dot4(_mm_unpacklo_epi8(px0123, zero), _mm_unpackhi_epi8(px0123, zero), c,
+        128, 8, 16);
+    __m128i const hi = dot4(_mm_unpacklo_epi8(px4567, zero), _mm_unpackhi_epi8(px4567, zero), c,
+        128, 8, 16);
+    __m128i const words = _mm_packs_epi32(lo, hi);
+    return _mm_packus_epi16(words, words);
+}
+
+// channel sums of the two 2x2 blocks in 4 pixels of each of two rows, 16-bit lanes
+__attribute__((target("sse2"))) inline __m128i block_sums(__m128i top, __m128i bottom)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const p01
+        = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+    __m128i const p23
+        = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+    return _mm_add_epi16(_mm_unpacklo_epi64(p01, p23), _mm_unpackhi_epi64(p01, p23));
+}
+
+__attribute__((target("sse2"))) inline void store4(uint8_t* out, __m128i values)
+{
+    __m128i const words = _mm_packs_epi32(values, values);
+    int32_t const bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+    std::memcpy(out, &bytes, 4);
+}
+
+// 8 pixels of both rows, 4 chroma blocks, a step; the scalar loop finishes the row
+__attribute__((target("sse2"))) void yuv_rows_sse2(RowPair const& rows)
+{
+    __m128i const cu = _mm_setr_epi16(-38, -74, 112, 0, -38, -74, 112, 0);
+    __m128i const cv = _mm_setr_epi16(112, -94, -18, 0, 112, -94, -18, 0);
+
+    unsigned x = 0;
+    for (; x + 8 <= rows.width; x += 8) {
+        __m128i const a0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rows.rgba0 + 4 * x));
+        __m128i const b0
+            = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rows.rgba0 + 4 * x + 16));
+        __m128i const a1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rows.rgba1 + 4 * x));
+        __m128i const b1
+            = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rows.rgba1 + 4 * x + 16));
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(rows.y0 + x), luma8(a0, b0));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(rows.y1 + x), luma8(a1, b1));
+
+        __m128i const sums01 = block_sums(a0, a1);
+        __m128i const sums23 = block_sums(b0, b1);
+        store4(rows.u + x / 2, dot4(sums01, sums23, cu, 512, 10, 128));
+        store4(rows.v + x / 2, dot4(sums01, sums23, cv, 512, 10, 128));
+    }
+
+    yuv_blocks_scalar(rows, x / 2);
+}
+
+#endif
+
+bool ends_with(std::string const& s, char const* suffix)
+{
+    size_t const n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+} // namespace
+
+void rgba_to_yuv420(uint8_t const* rgba, unsigned width, unsigned height, uint8_t* y, uint8_t* u,
+    uint8_t* v)
+{
+    void (*rows_fn)(RowPair const&) = yuv_rows_scalar;
+#ifdef YUV_KERNEL_X86
+    if (Matrices::get_simd_level() >= Matrices::SimdLevel::Sse2) {
+        rows_fn = yuv_rows_sse2;
+    }
+#endif
+
+    unsigned const chromaWidth = (width + 1) / 2;
+    for (unsigned row = 0; row < height; row += 2) {
+        unsigned const next = std::min(row + 1, height - 1);
+        rows_fn({ rgba + size_t(4) * width * row, rgba + size_t(4) * width * next,
+            y + size_t(width) * row, y + size_t(width) * next, u + size_t(chromaWidth) * (row / 2),
+            v + size_t(chromaWidth) * (row / 2), width });
+    }
+}
+
+FrameExporter::Format FrameExporter::formatOf(std::string const& path)
+{
+    if (ends_with(path, ".y4m")) {
+        return Format::Y4m;
+    }
+    if (ends_with(path, ".ppm")) {
+        return Format::Ppm;
+    }
+    throw std::runtime_error("Error: cannot export to " + path + ", expected a .y4m or .ppm path");
+}
+
+FrameExporter::FrameExporter(std::string const& path, int fps, size_t queueDepth)
+    : m_path(path)
+    , m_format(formatOf(path))
+    , m_fps(fps)
+    , m_buffers(std::max<size_t>(queueDepth, 1))
+    , m_free(m_buffers.size())
+    , m_queued(m_buffers.size())
+{
+    for (size_t i = 0; i < m_buffers.size(); i++) {
+        m_free[m_freeCount++] = i;
+    }
+
+    if (m_format == Format::Y4m) {
+        m_file = std::fopen(path.c_str(), "wb");
+        if (!m_file) {
+            throw std::runtime_error("Error: failed to open " + path);
+        }
+    }
+
+    m_writer = std::thread(&FrameExporter::writerLoop, this);
+}
+
+FrameExporter::~FrameExporter()
+{
+    try {
+        finish();
+    } catch (std::exception const&) {
+    }
+}
+
+void FrameExporter::submit(Framebuffer const& frame)
+{
+    if (frame.pixels.empty()) {
+        return;
+    }
+
+    if (m_width == 0) {
+        // everything the writer needs is sized here, once; the mutex below publishes it
+        m_width = frame.width;
+        m_height = frame.height;
+        for (std::vector<sf::Color>& buffer : m_buffers) {
+            buffer.resize(frame.pixels.size());
+        }
+        size_t const chroma = size_t((m_width + 1) / 2) * ((m_height + 1) / 2);
+        m_output.resize(m_format == Format::Y4m ? size_t(m_width) * m_height + 2 * chroma
+                                                : size_t(3) * m_width * m_height);
+        m_fileName.resize(m_path.size() + 32);
+    }
+
+    if (frame.width != m_width || frame.height != m_height) {
+        m_framesSkipped++;
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_bufferFreed.wait(lock, [this] { return m_freeCount > 0 || m_failed; });
+    if (m_failed) {
+        throw std::runtime_error("Error: failed to write frames to " + m_path);
+    }
+    size_t const buffer = m_free[--m_freeCount];
+
+    lock.unlock();
+    std::copy(frame.pixels.begin(), frame.pixels.end(), m_buffers[buffer].begin());
+    lock.lock();
+
+    m_queued[(m_queuedHead + m_queuedCount) % m_queued.size()] = buffer;
+    m_queuedCount++;
+    m_frameQueued.notify_one();
+}
+
+void FrameExporter::finish()
+{
+    if (m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_frameQueued.notify_one();
+        m_writer.join();
+
+        if (m_file && std::fclose(m_file) != 0) {
+            m_failed = true;
+        }
+        m_file = nullptr;
+    }
+
+    if (m_failed) {
+        throw std::runtime_error("Error: failed to write frames to " + m_path);
+    }
+}
+
+void FrameExporter::writerLoop()
+{
+    bool failed = false;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (;;) {
+        m_frameQueued.wait(lock, [this] { return m_queuedCount > 0 || m_stopping; });
+        if (m_queuedCount == 0) {
+            return; // stopping, and every frame is written
+        }
+        size_t const buffer = m_queued[m_queuedHead];
+
+        // once writing fails the rest are only drained, so submit() never blocks for good
+        lock.unlock();
+        failed = failed || !writeFrame(m_buffers[buffer].data());
+        lock.lock();
+
+        m_queuedHead = (m_queuedHead + 1) % m_queued.size();
+        m_queuedCount--;
+        m_free[m_freeCount++] = buffer;
+        m_failed = failed;
+        m_bufferFreed.notify_one();
+    }
+}
+
+bool FrameExporter::writeFrame(sf::Color const* pixels)
+{
+    bool const written = m_format == Format::Y4m ? writeY4m(pixels) : writePpm(pixels);
+    m_framesWritten += written;
+    return written;
+}
+
+bool FrameExporter::writeY4m(sf::Color const* pixels)
+{
+    // C420jpeg: chroma sited between the four luma samples it averages
+    if (m_framesWritten == 0
+        && std::fprintf(m_file, "YUV4MPEG2 W%u H%u F%d:1 Ip A1:1 C420jpeg\n", m_width, m_height,
+               m_fps)
+            < 0) {
+        return false;
+    }
+
+    size_t const lumaSize = size_t(m_width) * m_height;
+    size_t const chromaSize = (m_output.size() - lumaSize) / 2;
+    uint8_t* y = m_output.data();
+    rgba_to_yuv420(reinterpret_cast<uint8_t const*>(pixels), m_width, m_height, y, y + lumaSize,
+        y + lumaSize + chromaSize);
+
+    return std::fputs("FRAME\n", m_file) >= 0
+        && std::fwrite(m_output.data(), 1, m_output.size(), m_file) == m_output.size();
+}
+
+bool FrameExporter::writePpm(sf::Color const* pixels)
+{
+    size_t const stem = m_path.size() - 4; // without ".ppm"
+    std::snprintf(m_fileName.data(), m_fileName.size(), "%.*s_%06zu.ppm", int(stem),
+        m_path.c_str(), m_framesWritten);
+
+    for (size_t i = 0; i < size_t(m_width) * m_height; i++) {
+        m_output[3 * i] = pixels[i].r;
+        m_output[3 * i + 1] = pixels[i].g;
+        m_output[3 * i + 2] = pixels[i].b;
+    }
+
+    std::FILE* file = std::fopen(m_fileName.data(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool const written = std::fprintf(file, "P6\n%u %u\n255\n", m_width, m_height) >= 0
+        && std::fwrite(m_output.data(), 1, m_output.size(), file) == m_output.size();
+    return std::fclose(file) == 0 && written;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "RenderBackend.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// convert a width x height RGBA8 image to planar BT.601 limited-range YUV 4:2:0:
+/// y is width x height, u and v are ceil(width / 2) x ceil(height / 2), each chroma
+/// sample the average of its 2x2 block. SSE2 when get_simd_level() allows it.
+void rgba_to_yuv420(uint8_t const* rgba, unsigned width, unsigned height, uint8_t* y, uint8_t* u,
+    uint8_t* v);
+
+/// Writes rendered frames to disk on a thread of its own.
+///
+/// submit() copies a frame into one of queueDepth buffers and returns; the writer
+/// thread converts and writes queued frames in order, then hands the buffers back.
+/// The render loop only waits when every buffer is still queued, so a slow disk
+/// slows the run down instead of dropping frames. Buffers are allocated for the
+/// first frame and reused, so capture allocates nothing after it, and the writer
+/// uses stdio, which does not go through operator new.
+///
+/// The path's extension picks the format:
+///  - .y4m: one YUV4MPEG2 4:2:0 video, playable and encodable by ffmpeg/mpv;
+///  - .ppm: one binary PPM per frame, numbered before the extension
+///    (frames.ppm -> frames_000000.ppm, frames_000001.ppm, ...).
+/// Every frame takes the size of the first; frames of another size are skipped.
+class FrameExporter {
+public:
+    enum class Format { Y4m, Ppm };
+
+    /// the format path's extension selects; throws std::runtime_error for any other
+    static Format formatOf(std::string const& path);
+
+    /// throws std::runtime_error for an unknown extension or an unwritable .y4m path
+    FrameExporter(std::string const& path, int fps, size_t queueDepth = 4);
+
+    /// finish(), without reporting errors
+    ~FrameExporter();
+
+    FrameExporter(FrameExporter const&) = delete;
+    FrameExporter& operator=(FrameExporter const&) = delete;
+
+    /// queue a copy of frame for writing; throws std::runtime_error once writing has failed
+    void submit(Framebuffer const& frame);
+
+    /// write every queued frame, stop the writer and close the output;
+    /// throws std::runtime_error if writing failed
+    void finish();
+
+    std::string const& getPath() const { return m_path; }
+    size_t getFramesWritten() const { return m_framesWritten; }
+    size_t getFramesSkipped() const { return m_framesSkipped; }
+
+private:
+    std::string const m_path;
+    Format const m_format;
+    int const m_fps;
+    unsigned m_width = 0; // 0 until the first frame
+    unsigned m_height = 0;
+    size_t m_framesSkipped = 0;
+
+    // buffer indices cycle free -> queued -> free; both rings hold every index at most once
+    std::vector<std::vector<sf::Color>> m_buffers;
+    std::vector<size_t> m_free;
+    std::vector<size_t> m_queued;
+    size_t m_freeCount = 0;
+    size_t m_queuedHead = 0;
+    size_t m_queuedCount = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_bufferFreed;
+    std::condition_variable m_frameQueued;
+    bool m_stopping = false;
+    bool m_failed = false;
+
+    // writer thread only, after the first frame
+    std::FILE* m_file = nullptr; // the .y4m; each .ppm is opened as it is written
+    std::vector<uint8_t> m_output;
+    std::vector<char> m_fileName;
+    size_t m_framesWritten = 0;
+
+    std::thread m_writer;
+
+    void writerLoop();
+
+    /// convert and write one frame; false on an I/O error
+    bool writeFrame(sf::Color const* pixels);
+    bool writeY4m(sf::Color const* pixels);
+    bool writePpm(sf::Color const* pixels);
+};
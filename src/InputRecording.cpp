@@ -0,0 +1,105 @@
+#include "InputRecording.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+char const MAGIC[4] = { 'P', 'I', 'N', 'P' };
+uint32_t constexpr VERSION = 1;
+size_t constexpr HEADER_SIZE = 4 + 4 + 8 + 4;
+size_t constexpr FRAME_SIZE = 4 + 4 + 4 + 2 + 2 + 1;
+
+void put(std::vector<unsigned char>& out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+uint64_t get(unsigned char const*& in, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= uint64_t(*in++) << (8 * i);
+    }
+    return value;
+}
+
+uint32_t float_bits(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof bits);
+    return bits;
+}
+
+float bits_float(uint32_t bits)
+{
+    float x;
+    std::memcpy(&x, &bits, sizeof x);
+    return x;
+}
+} // namespace
+
+void InputRecording::save(std::string const& path) const
+{
+    std::vector<unsigned char> bytes(MAGIC, MAGIC + 4);
+    bytes.reserve(HEADER_SIZE + FRAME_SIZE * frames.size());
+
+    put(bytes, VERSION, 4);
+    put(bytes, seed, 8);
+    put(bytes, frames.size(), 4);
+
+    for (InputFrame const& frame : frames) {
+        put(bytes, float_bits(frame.dtAsSeconds), 4);
+        put(bytes, static_cast<uint32_t>(frame.mouseX), 4);
+        put(bytes, static_cast<uint32_t>(frame.mouseY), 4);
+        put(bytes, frame.viewportWidth, 2);
+        put(bytes, frame.viewportHeight, 2);
+        put(bytes, frame.mouseLeftPressed ? 1 : 0, 1);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<char const*>(bytes.data()), bytes.size());
+
+    if (!file) {
+        throw std::runtime_error("Error: failed to write input recording " + path);
+    }
+}
+
+InputRecording InputRecording::load(std::string const& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> const bytes(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (!file.is_open() || bytes.size() < HEADER_SIZE
+        || std::memcmp(bytes.data(), MAGIC, sizeof MAGIC) != 0) {
+        throw std::runtime_error("Error: " + path + " is not an input recording");
+    }
+
+    unsigned char const* in = bytes.data() + sizeof MAGIC;
+    if (get(in, 4) != VERSION) {
+        throw std::runtime_error("Error: unsupported input recording version in " + path);
+    }
+
+    InputRecording recording;
+    recording.seed = get(in, 8);
+    size_t const frameCount = get(in, 4);
+
+    if (bytes.size() != HEADER_SIZE + FRAME_SIZE * frameCount) {
+        throw std::runtime_error("Error: truncated input recording " + path);
+    }
+
+    recording.frames.resize(frameCount);
+    for (InputFrame& frame : recording.frames) {
+        frame.dtAsSeconds = bits_float(get(in, 4));
+        frame.mouseX = static_cast<int32_t>(get(in, 4));
+        frame.mouseY = static_cast<int32_t>(get(in, 4));
+        frame.viewportWidth = get(in, 2);
+        frame.viewportHeight = get(in, 2);
+        frame.mouseLeftPressed = get(in, 1) & 1;
+    }
+
+    return recording;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Everything Engine reads from the outside world in one frame.
+struct InputFrame {
+    float dtAsSeconds = 0;
+    int32_t mouseX = 0; // window pixels
+    int32_t mouseY = 0;
+    uint16_t viewportWidth = 0;
+    uint16_t viewportHeight = 0;
+    bool mouseLeftPressed = false;
+};
+
+/// A run's per-frame input plus the RNG seed it was drawn with, so the run can
+/// be replayed without a window and spawn exactly the same particles.
+///
+/// File layout, little-endian: "PINP", u32 version, u64 seed, u32 frame count,
+/// then per frame f32 dt, i32 mouse x, i32 mouse y, u16 width, u16 height,
+/// u8 buttons (bit 0 = left) - 17 bytes a frame, about 60 KB per minute at 60 fps.
+class InputRecording {
+public:
+    uint64_t seed = 0;
+    std::vector<InputFrame> frames;
+
+    /// throws std::runtime_error if the file cannot be written
+    void save(std::string const& path) const;
+
+    /// throws std::runtime_error if the file is missing, truncated or not a recording
+    static InputRecording load(std::string const& path);
+};
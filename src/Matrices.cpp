@@ -231,4 +231,38 @@ TranslationMatrix::TranslationMatrix(float xShift, float yShift, int nCols)
     }
 }
 
+AffineMatrix::AffineMatrix()
+{
+    (*this)(0, 0) = 1;
+    (*this)(1, 1) = 1;
+}
+
+AffineMatrix::AffineMatrix(
+    float theta, float c, float xCenter, float yCenter, float xShift, float yShift)
+{
+    // p' = cR(p - center) + center + shift
+    float const a = c * cos(theta);
+    float const b = c * sin(theta);
+
+    (*this)(0, 0) = a;
+    (*this)(0, 1) = -b;
+    (*this)(0, 2) = xCenter + xShift - (a * xCenter - b * yCenter);
+    (*this)(1, 0) = b;
+    (*this)(1, 1) = a;
+    (*this)(1, 2) = yCenter + yShift - (b * xCenter + a * yCenter);
+}
+
+void transform_points(AffineMatrix const& t, float* xs, float* ys, int n)
+{
+    float const a00 = t(0, 0), a01 = t(0, 1), tx = t(0, 2);
+    float const a10 = t(1, 0), a11 = t(1, 1), ty = t(1, 2);
+
+    for (int j = 0; j < n; j++) {
+        float const x = xs[j];
+        float const y = ys[j];
+        xs[j] = a00 * x + a01 * y + tx;
+        ys[j] = a10 * x + a11 * y + ty;
+    }
+}
+
 } // namespace Matrices
@@ -1,9 +1,11 @@
 #ifndef MATRIX_H_INCLUDED
 #define MATRIX_H_INCLUDED
 
+#include <array>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <stdexcept>
 #include <vector>
 
 namespace Matrices {
@@ -67,6 +69,74 @@ public:
 
 Matrix create_to_xyz_transformation_matrix(std::array<float, 3> ref_white);
 
+/*******************************************************************************/
+
+/// Compile-time sized matrix stored in a flat row-major std::array.
+/// Lives entirely on the stack, so arithmetic on it never allocates.
+template<int R, int C>
+class FixedMatrix {
+public:
+    FixedMatrix()
+        : m_values {}
+    {
+    }
+
+    float const& operator()(int i, int j) const { return m_values[i * C + j]; }
+    float& operator()(int i, int j) { return m_values[i * C + j]; }
+
+    static constexpr int rows() { return R; }
+    static constexpr int cols() { return C; }
+
+protected:
+    std::array<float, R * C> m_values;
+};
+
+/// 2 x cols() matrix of (x,y) columns with room for up to N columns.
+/// Row 0 holds every x, row 1 every y, each contiguous in memory.
+template<int N>
+class Points2xN {
+public:
+    explicit Points2xN(int cols = 0)
+        : m_values {}
+        , m_cols(cols)
+    {
+        if (cols < 0 || cols > N) {
+            throw std::domain_error("Error: column count exceeds capacity");
+        }
+    }
+
+    float const& operator()(int i, int j) const { return m_values[i * N + j]; }
+    float& operator()(int i, int j) { return m_values[i * N + j]; }
+
+    static constexpr int rows() { return 2; }
+    int cols() const { return m_cols; }
+    static constexpr int capacity() { return N; }
+
+    float* xs() { return m_values.data(); }
+    float* ys() { return m_values.data() + N; }
+    float const* xs() const { return m_values.data(); }
+    float const* ys() const { return m_values.data() + N; }
+
+protected:
+    std::array<float, 2 * N> m_values;
+    int m_cols;
+};
+
+/// 2D affine transform [A | t] packing a 2x2 linear part and a translation column.
+/// usage:  p' = A * p + t for every point, in a single pass
+class AffineMatrix : public FixedMatrix<2, 3> {
+public:
+    /// identity transform
+    AffineMatrix();
+
+    /// rotate theta radians counter-clockwise and scale by c about (xCenter, yCenter),
+    /// then shift by (xShift, yShift); equivalent to rotate, scale, translate in that order
+    AffineMatrix(float theta, float c, float xCenter, float yCenter, float xShift, float yShift);
+};
+
+/// apply t in place to the n points stored in xs and ys
+void transform_points(AffineMatrix const& t, float* xs, float* ys, int n);
+
 } // namespace Matrices
 
 #endif
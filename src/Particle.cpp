@@ -1,122 +1,61 @@
 #include "Particle.h"
 #include "Matrices.h"
-#include "config.h"
-#include "util.h"
-
-Particle::Particle(RenderTarget& target, sf::Color color, Vector2i mouseClickPosition)
-    : m_numPoints(getRandOddInt(10, 33))
-    , m_radiansPerSec(getRandInt(0, 1) * M_PI)
-    , m_vx(getRandInt(-500, 500))
-    , m_vy(getRandInt(100, 500))
-    , m_color1(sf::Color(255l, 255l, 255l))
-    , m_color2(color)
-    , m_A(2, m_numPoints)
-{
-
-    m_cartesianPlane.setCenter(0, 0);
-    m_cartesianPlane.setSize(target.getSize().x, (-1.0) * target.getSize().y);
-    m_centerCoordinate = target.mapPixelToCoords(mouseClickPosition, m_cartesianPlane);
-
-    double const dTheta = 2 * M_PI / (m_numPoints - 1);
-    double theta = getRandDouble(0, 1) * M_PI / 2;
-
-    double speed = std::sqrt(m_vx * m_vx + m_vy * m_vy);
-
-    // Define your expected maximum speed (tune as needed)
-    double const maxSpeed = std::sqrt(500 * 500 + 500 * 500);
+#include "ParticleSystem.h"
 
-    // Clamp speed to [0, maxSpeed]
-    speed = std::min(speed, maxSpeed);
-
-    // Normalize: map speed from [0, maxSpeed] to [0.5, 0]
-    double sizeFactor = 0.5 * (1.0 - (speed / maxSpeed));
-
-    m_ttl = TTL * sizeFactor * 2;
+Particle::Particle(ParticleSystem& system, size_t index)
+    : m_system(&system)
+    , m_index(index)
+{
+}
 
-    double baseRadius = getRandDouble(40, 50); // Some base size
-    double outerRadius = baseRadius * sizeFactor;
-    double innerRadius = outerRadius - 5.0; // Or some fixed thickness
+float Particle::getTTL() const
+{
+    return m_system->m_lifetime[m_index] - m_system->age(m_index);
+}
 
-    for (int j = 0; j < m_numPoints; j++) {
-        double r = (j % 2) ? innerRadius : outerRadius;
-        double dx = r * std::cos(theta);
-        double dy = r * std::sin(theta);
+Vector2f Particle::getCenter() const
+{
+    return m_system->centerAt(m_index, m_system->age(m_index));
+}
 
-        m_A(0, j) = m_centerCoordinate.x + dx;
-        m_A(1, j) = m_centerCoordinate.y + dy;
-        theta += dTheta;
-    }
+int Particle::getNumPoints() const { return m_system->m_numPoints[m_index]; }
 
-    // Initialize vertexArray ONCE per lifetime
-    m_shape = sf::VertexArray(sf::TriangleFan, m_numPoints + 1);
-    m_shape[0].color = m_color1;
-    for (size_t i = 1; i < m_shape.getVertexCount(); i++) {
-        m_shape[i].color = m_color2;
-    }
-}
+// nothing integrates over time, so aging one particle is just moving its spawn time back
+void Particle::update(float dt) { m_system->m_spawnTime[m_index] -= dt; }
 
-void Particle::update(RenderTarget& target, float dt)
+void Particle::draw(RenderTarget& target, RenderStates states) const
 {
-    auto decayToBlack = [](Color& color, int rate = 2) {
-        color.r = (color.r > rate) ? color.r - rate : 0;
-        color.g = (color.g > rate) ? color.g - rate : 0;
-        color.b = (color.b > rate) ? color.b - rate : 0;
-    };
-
-    m_ttl -= dt;
-    m_vy -= G * dt;
-
-    float const dx = m_vx * dt;
-    float const dy = m_vy * dt;
-
-    rotate(dt * m_radiansPerSec);
-    scale(SCALE);
-    translate(dx, dy);
-
-    decayToBlack(m_color1);
-    decayToBlack(m_color2);
-
-    m_shape[0].position
-        = sf::Vector2f(target.mapCoordsToPixel(m_centerCoordinate, m_cartesianPlane));
-    m_shape[0].color = m_color1;
-
-    for (int j = 1; j <= m_numPoints; j++) {
-        sf::Vector2f worldPos(m_A(0, j - 1), m_A(1, j - 1));
-        sf::Vector2i screenPos = target.mapCoordsToPixel(worldPos, m_cartesianPlane);
-        m_shape[j].position = static_cast<sf::Vector2f>(screenPos);
-        m_shape[j].color = m_color2;
-    }
+    sf::Vertex fan[ParticleSystem::VERTEX_STRIDE];
+    m_system->buildFan(m_index, fan);
+    target.draw(fan, getNumPoints() + 1, sf::TriangleFan, states);
 }
 
-void Particle::draw(RenderTarget& target, RenderStates states) const { target.draw(m_shape); }
-
-void Particle::rotate(double theta)
+Particle::Points Particle::getPoints() const
 {
-    Matrices::RotationMatrix const rotateMatrix(theta);
-    Vector2f const tempCoord = m_centerCoordinate;
+    sf::Vertex fan[ParticleSystem::VERTEX_STRIDE];
+    m_system->buildFan(m_index, fan);
+    Points points(getNumPoints());
+
+    for (int j = 0; j < points.cols(); j++) {
+        points(0, j) = fan[j + 1].position.x;
+        points(1, j) = fan[j + 1].position.y;
+    }
 
-    translate(-m_centerCoordinate.x, -m_centerCoordinate.y);
-    m_A = rotateMatrix * m_A;
-    translate(tempCoord.x, tempCoord.y);
+    return points;
 }
 
+void Particle::rotate(double theta) { m_system->m_angle[m_index] += theta; }
+
 void Particle::scale(double c)
 {
-    Matrices::ScalingMatrix const scaleMatrix(c);
-    Vector2f const tempCoord = m_centerCoordinate;
-
-    translate(-m_centerCoordinate.x, -m_centerCoordinate.y);
-    m_A = scaleMatrix * m_A;
-    translate(tempCoord.x, tempCoord.y);
+    m_system->m_outerRadius[m_index] *= c;
+    m_system->m_innerRadius[m_index] *= c;
 }
 
 void Particle::translate(double xShift, double yShift)
 {
-    Matrices::TranslationMatrix const transMatrix(xShift, yShift, m_numPoints);
-
-    m_A = transMatrix + m_A;
-    m_centerCoordinate.x += xShift;
-    m_centerCoordinate.y += yShift;
+    m_system->m_originX[m_index] += xShift;
+    m_system->m_originY[m_index] += yShift;
 }
 
 bool Particle::almostEqual(double a, double b, double eps) { return fabs(a - b) < eps; }
@@ -160,24 +99,26 @@ void Particle::unitTests()
 
     std::cout << "Testing Particles..." << std::endl;
     std::cout << "Testing Particle mapping to Cartesian origin..." << std::endl;
-    if (m_centerCoordinate.x != 0 || m_centerCoordinate.y != 0) {
-        std::cout << "Failed.  Expected (0,0).  Received: (" << m_centerCoordinate.x << ","
-                  << m_centerCoordinate.y << ")" << std::endl;
+    Vector2f const center = getCenter();
+    if (center.x != 0 || center.y != 0) {
+        std::cout << "Failed.  Expected (0,0).  Received: (" << center.x << "," << center.y << ")"
+                  << std::endl;
     } else {
         std::cout << "Passed.  +1" << std::endl;
         score++;
     }
 
     std::cout << "Applying one rotation of 90 degrees about the origin..." << std::endl;
-    Matrix initialCoords = m_A;
+    Points initialCoords = getPoints();
     rotate(M_PI / 2.0);
+    Points points = getPoints();
     bool rotationPassed = true;
     for (int j = 0; j < initialCoords.cols(); j++) {
-        if (!almostEqual(m_A(0, j), -initialCoords(1, j))
-            || !almostEqual(m_A(1, j), initialCoords(0, j))) {
+        if (!almostEqual(points(0, j), -initialCoords(1, j))
+            || !almostEqual(points(1, j), initialCoords(0, j))) {
             std::cout << "Failed mapping: ";
             std::cout << "(" << initialCoords(0, j) << ", " << initialCoords(1, j) << ") ==> ("
-                      << m_A(0, j) << ", " << m_A(1, j) << ")" << std::endl;
+                      << points(0, j) << ", " << points(1, j) << ")" << std::endl;
             rotationPassed = false;
         }
     }
@@ -189,15 +130,16 @@ void Particle::unitTests()
     }
 
     std::cout << "Applying a scale of 0.5..." << std::endl;
-    initialCoords = m_A;
+    initialCoords = getPoints();
     scale(0.5);
+    points = getPoints();
     bool scalePassed = true;
     for (int j = 0; j < initialCoords.cols(); j++) {
-        if (!almostEqual(m_A(0, j), 0.5 * initialCoords(0, j))
-            || !almostEqual(m_A(1, j), 0.5 * initialCoords(1, j))) {
+        if (!almostEqual(points(0, j), 0.5 * initialCoords(0, j))
+            || !almostEqual(points(1, j), 0.5 * initialCoords(1, j))) {
             std::cout << "Failed mapping: ";
             std::cout << "(" << initialCoords(0, j) << ", " << initialCoords(1, j) << ") ==> ("
-                      << m_A(0, j) << ", " << m_A(1, j) << ")" << std::endl;
+                      << points(0, j) << ", " << points(1, j) << ")" << std::endl;
             scalePassed = false;
         }
     }
@@ -209,15 +151,16 @@ void Particle::unitTests()
     }
 
     std::cout << "Applying a translation of (10, 5)..." << std::endl;
-    initialCoords = m_A;
+    initialCoords = getPoints();
     translate(10, 5);
+    points = getPoints();
     bool translatePassed = true;
     for (int j = 0; j < initialCoords.cols(); j++) {
-        if (!almostEqual(m_A(0, j), 10 + initialCoords(0, j))
-            || !almostEqual(m_A(1, j), 5 + initialCoords(1, j))) {
+        if (!almostEqual(points(0, j), 10 + initialCoords(0, j))
+            || !almostEqual(points(1, j), 5 + initialCoords(1, j))) {
             std::cout << "Failed mapping: ";
             std::cout << "(" << initialCoords(0, j) << ", " << initialCoords(1, j) << ") ==> ("
-                      << m_A(0, j) << ", " << m_A(1, j) << ")" << std::endl;
+                      << points(0, j) << ", " << points(1, j) << ")" << std::endl;
             translatePassed = false;
         }
     }
@@ -228,5 +171,32 @@ void Particle::unitTests()
         std::cout << "Failed." << std::endl;
     }
 
-    std::cout << "Score: " << score << " / 7" << std::endl;
+    std::cout << "Applying a fused rotation, scale and translation..." << std::endl;
+    initialCoords = getPoints();
+    Vector2f const fusedCenter = getCenter();
+    rotate(M_PI / 3.0);
+    scale(0.75);
+    translate(-4, 8);
+    points = getPoints();
+    Points fused = initialCoords;
+    transform_points(AffineMatrix(M_PI / 3.0, 0.75, fusedCenter.x, fusedCenter.y, -4, 8),
+        fused.xs(), fused.ys(), fused.cols());
+    bool fusedPassed = true;
+    for (int j = 0; j < initialCoords.cols(); j++) {
+        if (!almostEqual(points(0, j), fused(0, j), 0.001)
+            || !almostEqual(points(1, j), fused(1, j), 0.001)) {
+            std::cout << "Failed mapping: ";
+            std::cout << "(" << initialCoords(0, j) << ", " << initialCoords(1, j) << ") ==> ("
+                      << fused(0, j) << ", " << fused(1, j) << ")" << std::endl;
+            fusedPassed = false;
+        }
+    }
+    if (fusedPassed) {
+        std::cout << "Passed.  +1" << std::endl;
+        score++;
+    } else {
+        std::cout << "Failed." << std::endl;
+    }
+
+    std::cout << "Score: " << score << " / 8" << std::endl;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "Matrices.h"
+#include "ShapeCache.h"
 #include <SFML/Graphics.hpp>
 
 #define _USE_MATH_DEFINES // for vs
@@ -7,43 +8,41 @@
 using namespace Matrices;
 using namespace sf;
 
+class ParticleSystem;
+
+/// Lightweight handle onto one entry of a ParticleSystem.
+/// Copying a Particle copies the handle, not the particle data.
 class Particle : public Drawable {
 public:
-    static float constexpr G = 1000;  // Gravity
-    static float constexpr TTL = 2.0; // Time To Live
-    static float constexpr SCALE = 0.99;
+    static int constexpr MAX_POINTS = ShapeCache::MAX_POINTS;
+
+    using Points = Points2xN<MAX_POINTS>;
 
-    Particle(RenderTarget& target, sf::Color color, Vector2i mouseClickPosition);
-    void update(RenderTarget& target, float dt);
+    Particle(ParticleSystem& system, size_t index);
+    /// age this particle, and only this one, by dt seconds
+    void update(float dt);
     virtual void draw(RenderTarget& target, RenderStates states) const override;
-    float getTTL() { return m_ttl; }
+    float getTTL() const;
+    Vector2f getCenter() const;
+    int getNumPoints() const;
 
     // Functions for unit testing
     bool almostEqual(double a, double b, double eps = 0.0001);
     void unitTests();
 
 private:
-    float m_ttl;
-    int m_numPoints;
-    Vector2f m_centerCoordinate;
-    float m_radiansPerSec;
-    float m_vx;
-    float m_vy;
-    View m_cartesianPlane;
-    Color m_color1;
-    Color m_color2;
-    Matrix m_A;
-    sf::VertexArray m_shape;
-
-    /// rotate Particle by theta radians counter-clockwise
-    /// construct a RotationMatrix R, left multiply it to m_A
+    ParticleSystem* m_system;
+    size_t m_index;
+
+    /// build the outline points into a 2 x numPoints stack matrix, one (x,y) per column
+    Points getPoints() const;
+
+    /// rotate Particle by theta radians counter-clockwise about its center
     void rotate(double theta);
 
-    /// Scale the size of the Particle by factor c
-    /// construct a ScalingMatrix S, left multiply it to m_A
+    /// Scale the size of the Particle by factor c about its center
     void scale(double c);
 
     /// shift the Particle by (xShift, yShift) coordinates
-    /// construct a TranslationMatrix T, add it to m_A
     void translate(double xShift, double yShift);
 };
@@ -0,0 +1,150 @@
+#include "ParticleInteractions.h"
+#include "../lib/Timer.h"
+#include "grow.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool ParticleInteractions::pairwise() const
+{
+    return m_settings.radius > 0 && (m_settings.repulsion != 0 || m_settings.cohesion != 0);
+}
+
+bool ParticleInteractions::enabled() const
+{
+    return pairwise() || fielded() || m_settings.collideEdges;
+}
+
+void ParticleInteractions::forRange(size_t count, ThreadPool::RangeFn const& fn)
+{
+    if (m_pool) {
+        m_pool->parallelFor(count, GRAIN, fn);
+    } else {
+        fn(0, count);
+    }
+}
+
+void ParticleInteractions::step(ParticleSystem& particles, float dt, sf::FloatRect const& bounds)
+{
+    // only visible particles take part: unspawned and expired ones sit at positions
+    // nothing is drawn at, and would crowd the grid and push on the live ones. The
+    // buffers are sized by the pool, not the visible count, which can keep rising
+    // long after warm-up.
+    size_t const capacity = particles.size();
+    grow_to(m_live, capacity);
+    grow_to(m_x, capacity);
+    grow_to(m_y, capacity);
+    grow_to(m_vx, capacity);
+    grow_to(m_vy, capacity);
+    size_t count = 0;
+    for (size_t i = 0; i < capacity; i++) {
+        if (particles.isVisible(i)) {
+            m_live[count++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    struct Job {
+        ParticleInteractions& self;
+        ParticleSystem& particles;
+        float dt;
+        sf::FloatRect bounds;
+    } const job { *this, particles, dt, bounds };
+
+    forRange(count, [&job](size_t first, size_t last) {
+        ParticleInteractions& self = job.self;
+        for (size_t k = first; k < last; k++) {
+            Vector2f const center = job.particles.getCenter(self.m_live[k]);
+            Vector2f const velocity = job.particles.getVelocity(self.m_live[k]);
+            self.m_x[k] = center.x;
+            self.m_y[k] = center.y;
+            self.m_vx[k] = velocity.x;
+            self.m_vy[k] = velocity.y;
+        }
+    });
+
+    if (fielded()) {
+        PROFILE_SCOPE("forces");
+        forRange(count, [&job](size_t first, size_t last) {
+            ParticleInteractions& self = job.self;
+            self.m_field->accelerate(&self.m_x[first], &self.m_y[first], &self.m_vx[first],
+                &self.m_vy[first], last - first, job.dt);
+        });
+    }
+
+    if (pairwise()) {
+        PROFILE_SCOPE("neighbours");
+        float const radius = m_settings.radius;
+        m_grid.setCellSize(
+            m_settings.cellSize > 0 ? std::max(m_settings.cellSize, radius / 3) : radius);
+        m_grid.reserve(capacity);
+        m_grid.build(m_x.data(), m_y.data(), count, m_pool);
+
+        // in grid order, so neighbouring particles are also neighbours in memory; each
+        // particle writes only its own velocity and reads only positions
+        forRange(count, [&job](size_t first, size_t last) {
+            ParticleInteractions& self = job.self;
+            Settings const& s = self.m_settings;
+            float const* xs = self.m_grid.sortedX();
+            float const* ys = self.m_grid.sortedY();
+            float const radiusSquared = s.radius * s.radius;
+
+            for (size_t k = first; k < last; k++) {
+                float const x = xs[k];
+                float const y = ys[k];
+                float ax = 0;
+                float ay = 0;
+
+                self.m_grid.forEachCandidate(x, y, s.radius, [&](uint32_t j) {
+                    float const dx = x - xs[j];
+                    float const dy = y - ys[j];
+                    float const distanceSquared = dx * dx + dy * dy;
+                    // itself, or spawned on the same spot: no direction to push in
+                    if (distanceSquared >= radiusSquared || distanceSquared == 0) {
+                        return;
+                    }
+                    float const distance = std::sqrt(distanceSquared);
+                    float const q = distance / s.radius;
+                    float const push = s.repulsion * (1 - q) - s.cohesion * 4 * q * (1 - q);
+                    ax += push * dx / distance;
+                    ay += push * dy / distance;
+                });
+
+                uint32_t const i = self.m_grid.order()[k];
+                self.m_vx[i] += ax * job.dt;
+                self.m_vy[i] += ay * job.dt;
+            }
+        });
+    }
+
+    forRange(count, [&job](size_t first, size_t last) {
+        ParticleInteractions& self = job.self;
+        Settings const& s = self.m_settings;
+        float const left = job.bounds.left;
+        float const right = job.bounds.left + job.bounds.width;
+        float const bottom = job.bounds.top; // y is up, so the rectangle's top is its bottom
+        float const top = job.bounds.top + job.bounds.height;
+
+        for (size_t k = first; k < last; k++) {
+            Vector2f center(self.m_x[k], self.m_y[k]);
+            Vector2f velocity(self.m_vx[k], self.m_vy[k]);
+            bool bounced = false;
+
+            if (s.collideEdges) {
+                if ((center.x < left && velocity.x < 0) || (center.x > right && velocity.x > 0)) {
+                    center.x = std::clamp(center.x, left, right);
+                    velocity.x *= -s.restitution;
+                    bounced = true;
+                }
+                if ((center.y < bottom && velocity.y < 0) || (center.y > top && velocity.y > 0)) {
+                    center.y = std::clamp(center.y, bottom, top);
+                    velocity.y *= -s.restitution;
+                    bounced = true;
+                }
+            }
+
+            if (bounced || self.pairwise() || self.fielded()) {
+                job.particles.setMotion(self.m_live[k], center, velocity);
+            }
+        }
+    });
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "ForceField.h"
+#include "ParticleSystem.h"
+#include "SpatialHash.h"
+#include "ThreadPool.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+/// Forces between nearby particles, from a ForceField, and bounces off the edges
+/// of the view.
+///
+/// Each step() snapshots every visible particle's center and velocity, sorts the
+/// centers into a SpatialHash and sums, on the thread pool, the pull of each
+/// particle's neighbours within radius - O(n) for a bounded density, where all pairs
+/// would be O(n^2). For a pair at distance d, with q = d / radius:
+///     repulsion pushes them apart at  repulsion * (1 - q)
+///     cohesion pulls them together at cohesion * 4q(1 - q), strongest at radius / 2
+/// so with both on, particles drift toward a preferred spacing. A force field adds
+/// its baked acceleration in the same pass. The new velocities go back through
+/// ParticleSystem::setMotion(), which keeps motion in closed form.
+class ParticleInteractions {
+public:
+    struct Settings {
+        float radius = 0;          // world units; 0 turns the pairwise forces off
+        float cellSize = 0;        // grid cells, at least radius / 3; 0 uses radius
+        float repulsion = 0;       // world units / s^2 at contact
+        float cohesion = 0;        // world units / s^2 at radius / 2
+        bool collideEdges = false; // bounce centers off the bounds given to step()
+        float restitution = 0.6f;  // share of its speed a particle keeps through a bounce
+    };
+
+    static size_t constexpr GRAIN = 1024; // particles per parallel chunk
+
+    void setSettings(Settings const& settings) { m_settings = settings; }
+    Settings const& getSettings() const { return m_settings; }
+
+    /// run on pool's threads; nullptr runs on the caller
+    void setThreadPool(ThreadPool* pool) { m_pool = pool; }
+
+    /// also accelerate particles by field, already baked over step()'s bounds; nullptr for none
+    void setForceField(ForceField const* field) { m_field = field; }
+
+    /// whether step() has anything to do
+    bool enabled() const;
+
+    /// apply dt seconds of forces to particles at their current time, then bounce
+    /// any center outside bounds (world space, y up) back in
+    void step(ParticleSystem& particles, float dt, sf::FloatRect const& bounds);
+
+    /// the grid the last step() built
+    SpatialHash const& getGrid() const { return m_grid; }
+
+private:
+    Settings m_settings;
+    ThreadPool* m_pool = nullptr;
+    ForceField const* m_field = nullptr;
+    SpatialHash m_grid;
+
+    // the step's visible particles, then their snapshot in the same order; each is
+    // pool-sized and only its first visible-count entries are used
+    std::vector<uint32_t> m_live;
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_vx;
+    std::vector<float> m_vy;
+
+    bool pairwise() const;
+    bool fielded() const { return m_field && !m_field->empty(); }
+
+    /// run fn over [0, count) in GRAIN chunks, on the pool if there is one
+    void forRange(size_t count, ThreadPool::RangeFn const& fn);
+};
@@ -0,0 +1,251 @@
+#include "ParticleSystem.h"
+#include "TransformKernel.h"
+#include "../lib/Timer.h"
+#include "grow.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cmath>
+
+Particle ParticleSystem::spawn(Color color, Vector2f center)
+{
+    spawn(1, center, &color, 1, 0);
+    return Particle(*this, size() - 1);
+}
+
+void ParticleSystem::spawn(size_t count, Vector2f center, Color const* palette,
+    size_t paletteSize, size_t firstColor)
+{
+    // draw each random field for the whole batch at once
+    SpawnBatch& batch = m_spawnBatch;
+    batch.resize(count);
+
+    Rng& rng = thread_rng();
+    rng.fillInt(batch.numPoints.data(), count, 10, MAX_POINTS);
+    rng.fillInt(batch.spin.data(), count, 0, 1);
+    rng.fillInt(batch.vx.data(), count, -500, 500);
+    rng.fillInt(batch.vy.data(), count, 100, 500);
+    rng.fillDouble(batch.theta.data(), count, 0, 1);
+    rng.fillDouble(batch.baseRadius.data(), count, 40, 50); // Some base size
+
+    m_centerFadeRow = m_fades.row(sf::Color(255, 255, 255));
+
+    if (size() + count > capacity()) {
+        reserve(std::max({ 2 * capacity(), size() + count, MIN_CAPACITY }));
+    }
+
+    // Define your expected maximum speed (tune as needed)
+    double const maxSpeed = std::sqrt(500 * 500 + 500 * 500);
+
+    for (size_t k = 0; k < count; k++) {
+        size_t const index = m_count++;
+
+        int const numPoints = batch.numPoints[k] % 2 ? batch.numPoints[k] : batch.numPoints[k] - 1;
+        float const vx = batch.vx[k];
+        float const vy = batch.vy[k];
+
+        // Clamp speed to [0, maxSpeed]
+        double const speed = std::min<double>(std::sqrt(vx * vx + vy * vy), maxSpeed);
+
+        // Normalize: map speed from [0, maxSpeed] to [0.5, 0]
+        double const sizeFactor = 0.5 * (1.0 - (speed / maxSpeed));
+
+        double const outerRadius = batch.baseRadius[k] * sizeFactor;
+        double const innerRadius = outerRadius - 5.0; // Or some fixed thickness
+
+        m_spawnTime[index] = m_time;
+        m_lifetime[index] = m_physics.ttl * sizeFactor * 2;
+        m_numPoints[index] = numPoints;
+        m_originX[index] = center.x;
+        m_originY[index] = center.y;
+        m_vx[index] = vx;
+        m_vy[index] = vy;
+        m_radiansPerSec[index] = batch.spin[k] * M_PI;
+        m_angle[index] = batch.theta[k] * M_PI / 2;
+        m_outerRadius[index] = outerRadius;
+        m_innerRadius[index] = innerRadius;
+        m_fadeRow[index] = m_fades.row(palette[(firstColor + k) % paletteSize]);
+    }
+}
+
+void ParticleSystem::buildFan(size_t i, sf::Vertex* fan) const
+{
+    ShapeCache::Shape const& shape = m_shapes.get(m_numPoints[i]);
+    float const age = this->age(i);
+    Vector2f const center = centerAt(i, age);
+    float const angle = m_angle[i] + m_radiansPerSec[i] * age;
+    float const scale = std::pow(m_physics.scalePerSecond, age);
+
+    // template points alternate rings, so each ring fills every other outline vertex
+    AffineMatrix const outer(angle, scale * m_outerRadius[i], 0, 0, center.x, center.y);
+    AffineMatrix const inner(angle, scale * m_innerRadius[i], 0, 0, center.x, center.y);
+    transform_points_to_vertices(
+        outer, shape.outerX.data(), shape.outerY.data(), shape.outerCount(), fan + 1, 2);
+    transform_points_to_vertices(
+        inner, shape.innerX.data(), shape.innerY.data(), shape.innerCount(), fan + 2, 2);
+
+    float const lifeSpent = (m_lifetime[i] > 0) ? age / m_lifetime[i] : 1.f;
+    sf::Color const outline = m_fades.at(m_fadeRow[i], lifeSpent);
+
+    fan[0].position = center;
+    fan[0].color = m_fades.at(m_centerFadeRow, lifeSpent);
+    for (int j = 1; j <= m_numPoints[i]; j++) {
+        fan[j].color = outline;
+    }
+}
+
+void ParticleSystem::setMotion(size_t index, Vector2f position, Vector2f velocity)
+{
+    // solve getCenter(index) == position and getVelocity(index) == velocity for the
+    // spawn origin and velocity, at the particle's current age
+    float const a = age(index);
+    float const g = m_physics.gravity;
+    m_vx[index] = velocity.x;
+    m_vy[index] = velocity.y + g * a;
+    m_originX[index] = position.x - m_vx[index] * a;
+    m_originY[index] = position.y - (m_vy[index] - 0.5f * g * a) * a;
+}
+
+void ParticleSystem::removeDead()
+{
+    PROFILE_SCOPE("removeDead");
+    switch (m_removalPolicy) {
+    case RemovalPolicy::Stable: {
+        size_t alive = 0;
+
+        for (size_t i = 0; i < size(); i++) {
+            if (age(i) < m_lifetime[i]) {
+                moveSlot(i, alive++);
+            }
+        }
+        m_count = alive;
+        break;
+    }
+    case RemovalPolicy::SwapAndPop: {
+        size_t i = 0;
+
+        while (i < size()) {
+            if (age(i) < m_lifetime[i]) {
+                i++;
+            } else {
+                moveSlot(--m_count, i);
+            }
+        }
+        break;
+    }
+    }
+}
+
+void ParticleSystem::moveSlot(size_t from, size_t to)
+{
+    if (from == to) {
+        return;
+    }
+
+    m_spawnTime[to] = m_spawnTime[from];
+    m_lifetime[to] = m_lifetime[from];
+    m_numPoints[to] = m_numPoints[from];
+    m_originX[to] = m_originX[from];
+    m_originY[to] = m_originY[from];
+    m_vx[to] = m_vx[from];
+    m_vy[to] = m_vy[from];
+    m_radiansPerSec[to] = m_radiansPerSec[from];
+    m_angle[to] = m_angle[from];
+    m_outerRadius[to] = m_outerRadius[from];
+    m_innerRadius[to] = m_innerRadius[from];
+    m_fadeRow[to] = m_fadeRow[from];
+}
+
+void ParticleSystem::preparePalette(Color const* palette, size_t paletteSize)
+{
+    m_centerFadeRow = m_fades.row(sf::Color(255, 255, 255));
+    for (size_t i = 0; i < paletteSize; i++) {
+        m_fades.row(palette[i]);
+    }
+}
+
+void ParticleSystem::reserve(size_t capacity)
+{
+    if (capacity <= this->capacity()) {
+        return;
+    }
+
+    m_spawnTime.resize(capacity);
+    m_lifetime.resize(capacity);
+    m_numPoints.resize(capacity);
+    m_originX.resize(capacity);
+    m_originY.resize(capacity);
+    m_vx.resize(capacity);
+    m_vy.resize(capacity);
+    m_radiansPerSec.resize(capacity);
+    m_angle.resize(capacity);
+    m_outerRadius.resize(capacity);
+    m_innerRadius.resize(capacity);
+    m_fadeRow.resize(capacity);
+    m_batchOffsets.resize(capacity);
+}
+
+size_t ParticleSystem::buildBatch() const
+{
+    PROFILE_SCOPE("buildBatch");
+    // a fan of n outline points is n - 1 triangles sharing the center vertex
+    size_t batchSize = 0;
+    for (size_t i = 0; i < size(); i++) {
+        m_batchOffsets[i] = batchSize;
+        if (isVisible(i)) {
+            batchSize += 3 * (m_numPoints[i] - 1);
+        }
+    }
+
+    grow_to(m_batch, batchSize);
+
+    if (m_pool) {
+        m_pool->parallelFor(size(), BUILD_GRAIN,
+            [this](size_t first, size_t last) { buildRange(first, last); });
+    } else {
+        buildRange(0, size());
+    }
+
+    return batchSize;
+}
+
+void ParticleSystem::buildRange(size_t first, size_t last) const
+{
+    sf::Vertex fan[VERTEX_STRIDE];
+
+    for (size_t i = first; i < last; i++) {
+        if (!isVisible(i)) {
+            continue;
+        }
+
+        buildFan(i, fan);
+
+        sf::Vertex* out = m_batch.data() + m_batchOffsets[i];
+        for (int j = 1; j < m_numPoints[i]; j++) {
+            *out++ = fan[0];
+            *out++ = fan[j];
+            *out++ = fan[j + 1];
+        }
+    }
+}
+
+void ParticleSystem::draw(RenderTarget& target, RenderStates states) const
+{
+    PROFILE_SCOPE("drawBatch");
+    size_t const batchSize = buildBatch();
+
+    if (batchSize == 0) {
+        return;
+    }
+
+    if (!sf::VertexBuffer::isAvailable()) {
+        target.draw(m_batch.data(), batchSize, sf::Triangles, states);
+        return;
+    }
+
+    if (m_batchBuffer.getVertexCount() < batchSize) {
+        m_batchBuffer.create(m_batch.capacity());
+    }
+    m_batchBuffer.update(m_batch.data(), batchSize, 0);
+    target.draw(m_batchBuffer, 0, batchSize, states);
+}
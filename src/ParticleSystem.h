@@ -0,0 +1,197 @@
+#pragma once
+#include "FadeTable.h"
+#include "Particle.h"
+#include "ThreadPool.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+/// Structure-of-arrays store for every live particle.
+/// Each field lives in its own contiguous array indexed by particle, so the
+/// draw loop streams through memory instead of chasing per-particle objects.
+/// Particle is a lightweight handle (store + index) onto one entry.
+/// Positions are in world space: a Cartesian plane, y up, that the owner maps
+/// onto the screen when drawing.
+///
+/// Motion is ballistic, so a particle stores only what it was spawned with
+/// (spawn time, origin, initial velocity, spin, shape) and its pose at any age
+/// is evaluated in closed form when drawn:
+///     center = origin + velocity * age - (0, gravity * age^2 / 2)
+///     angle  = angle at spawn + spin * age
+///     scale  = scalePerSecond ^ age
+/// update() only advances the system clock and writes nothing per particle;
+/// results do not depend on the frame rate, and seek() renders any time directly.
+/// Anything that deflects a particle (interactions, edges) calls setMotion(),
+/// which restarts its closed form from where it is at that moment.
+///
+/// Outlines are not stored per particle either: the vertices are generated at
+/// draw time from the shared unit template for its point count. Colors likewise
+/// come from a shared fade table, looked up by how far through its life a particle is.
+///
+/// The arrays double as a slot pool: live particles occupy slots [0, size()) and
+/// the free slots are always the tail [size(), capacity()), so spawning reuses a
+/// slot freed by removeDead() and only reallocates when the pool is full.
+class ParticleSystem : public Drawable {
+public:
+    /// how removeDead() closes the gaps left by expired particles
+    enum class RemovalPolicy {
+        Stable,    // shift survivors down, keeping spawn (and draw) order
+        SwapAndPop // move the last particle into each hole, O(1) per removal
+    };
+
+    /// motion shared by every particle; Config sets it at startup
+    struct Physics {
+        float gravity = 1000;           // world units / s^2
+        float ttl = 2.0;                // seconds the slowest particle lives
+        float scalePerSecond = 0.5472f; // size left after a second, 0.99 a frame at 60 fps
+    };
+
+    static int constexpr MAX_POINTS = Particle::MAX_POINTS;
+    static int constexpr VERTEX_STRIDE = MAX_POINTS + 1; // center + outline
+    static size_t constexpr BUILD_GRAIN = 512;            // particles per parallel chunk
+    static size_t constexpr MIN_CAPACITY = 1024;          // first pool allocation
+
+    /// create a particle at center (world space) and return a handle to it
+    Particle spawn(Color color, Vector2f center);
+
+    /// create count particles at center, the k-th colored palette[(firstColor + k) % paletteSize];
+    /// their random parameters are drawn a field at a time for the whole batch
+    void spawn(size_t count, Vector2f center, Color const* palette, size_t paletteSize,
+        size_t firstColor);
+
+    /// build the fade rows for every palette color up front, so spawning them
+    /// later allocates nothing
+    void preparePalette(Color const* palette, size_t paletteSize);
+
+    /// advance the clock by dt seconds
+    void update(float dt) { m_time += dt; }
+
+    /// jump the clock to time, in seconds since the system was created. Particles
+    /// spawned later are hidden until the clock reaches them again; particles
+    /// removeDead() has dropped are gone for good.
+    void seek(double time) { m_time = time; }
+    double getTime() const { return m_time; }
+
+    /// world-space center and velocity of particle index at the current time
+    Vector2f getCenter(size_t index) const { return centerAt(index, age(index)); }
+    Vector2f getVelocity(size_t index) const
+    {
+        return { m_vx[index], m_vy[index] - m_physics.gravity * age(index) };
+    }
+
+    /// whether particle index has spawned and not yet expired at the current time
+    bool isVisible(size_t index) const
+    {
+        float const a = age(index);
+        return a >= 0 && a < m_lifetime[index];
+    }
+
+    /// move particle index to position with velocity at the current time, from where
+    /// it falls ballistically again. Rewrites its spawn origin and velocity to match,
+    /// so seek() after this follows the new path back in time, not the one it had.
+    void setMotion(size_t index, Vector2f position, Vector2f velocity);
+
+    /// drop particles whose lifetime has run out at the current time, according
+    /// to the removal policy
+    void removeDead();
+
+    /// build the vertices of draw() on pool's threads; nullptr builds on the caller
+    void setThreadPool(ThreadPool* pool) { m_pool = pool; }
+
+    /// generate every visible particle's triangles at the current time into the
+    /// batch draw() submits, and return the vertex count
+    size_t buildBatch() const;
+
+    /// the sf::Triangles list buildBatch() last built
+    sf::Vertex const* getBatch() const { return m_batch.data(); }
+
+    void setPhysics(Physics const& physics) { m_physics = physics; }
+    Physics const& getPhysics() const { return m_physics; }
+
+    void setRemovalPolicy(RemovalPolicy policy) { m_removalPolicy = policy; }
+    RemovalPolicy getRemovalPolicy() const { return m_removalPolicy; }
+
+    /// grow the pool so at least capacity particles fit without reallocating
+    void reserve(size_t capacity);
+    void clear() { m_count = 0; }
+    size_t size() const { return m_count; }
+    size_t capacity() const { return m_spawnTime.size(); }
+    bool empty() const { return m_count == 0; }
+
+    Particle operator[](size_t index) { return Particle(*this, index); }
+
+    /// submit every particle in a single draw call; particles live in world
+    /// space, so states.transform must map that onto the target
+    virtual void draw(RenderTarget& target, RenderStates states) const override;
+
+private:
+    friend class Particle;
+
+    size_t m_count = 0;
+    double m_time = 0; // seconds; double so ages stay exact over long runs
+    RemovalPolicy m_removalPolicy = RemovalPolicy::Stable;
+    Physics m_physics;
+    ThreadPool* m_pool = nullptr;
+
+    // spawn parameters, one entry per slot; none of them change as the particle ages
+    std::vector<double> m_spawnTime;
+    std::vector<float> m_lifetime; // seconds
+    std::vector<int> m_numPoints;
+    std::vector<float> m_originX;
+    std::vector<float> m_originY;
+    std::vector<float> m_vx;
+    std::vector<float> m_vy;
+    std::vector<float> m_radiansPerSec;
+    std::vector<float> m_angle;
+    std::vector<float> m_outerRadius; // before shrinking
+    std::vector<float> m_innerRadius;
+    std::vector<uint32_t> m_fadeRow; // outline color; the fan center fades from white
+
+    ShapeCache m_shapes;
+    FadeTable m_fades;
+    uint32_t m_centerFadeRow = 0;
+
+    // spawn() scratch, one entry per particle being created; capacity is reused
+    struct SpawnBatch {
+        std::vector<int> numPoints;
+        std::vector<int> spin;
+        std::vector<int> vx;
+        std::vector<int> vy;
+        std::vector<double> theta;
+        std::vector<double> baseRadius;
+
+        void resize(size_t count)
+        {
+            numPoints.resize(count);
+            spin.resize(count);
+            vx.resize(count);
+            vy.resize(count);
+            theta.resize(count);
+            baseRadius.resize(count);
+        }
+    } m_spawnBatch;
+
+    // every fan unrolled into one sf::Triangles list, rebuilt each draw; capacity is reused
+    mutable std::vector<sf::Vertex> m_batch;
+    mutable std::vector<size_t> m_batchOffsets; // first vertex of each slot, sized to capacity
+    mutable sf::VertexBuffer m_batchBuffer { sf::Triangles, sf::VertexBuffer::Stream };
+
+    /// seconds since particle i spawned; negative if it spawns after the current time
+    float age(size_t i) const { return static_cast<float>(m_time - m_spawnTime[i]); }
+
+    Vector2f centerAt(size_t i, float age) const
+    {
+        return { m_originX[i] + m_vx[i] * age,
+            m_originY[i] + (m_vy[i] - 0.5f * m_physics.gravity * age) * age };
+    }
+
+    /// write the triangle fan of particle i at its current age into fan: the center,
+    /// then its outline points; fan must hold VERTEX_STRIDE vertices
+    void buildFan(size_t i, sf::Vertex* fan) const;
+
+    /// unroll the fans of slots [first, last) into m_batch at m_batchOffsets; touches
+    /// nothing outside the range, so disjoint ranges may run concurrently
+    void buildRange(size_t first, size_t last) const;
+
+    /// copy every field of slot from into slot to
+    void moveSlot(size_t from, size_t to);
+};
@@ -0,0 +1,115 @@
+#include "Random.h"
+
+#include <atomic>
+#include <random>
+
+namespace {
+uint64_t splitmix64(uint64_t& x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+uint64_t random_device_seed()
+{
+    std::random_device device;
+    return (uint64_t(device()) << 32) | device();
+}
+
+std::atomic<uint64_t> g_seed { random_device_seed() };
+std::atomic<uint64_t> g_generation { 0 };
+std::atomic<uint64_t> g_nextThread { 0 };
+} // namespace
+
+Rng::Rng(uint64_t seed) { this->seed(seed); }
+
+void Rng::seed(uint64_t seed)
+{
+    for (uint64_t& word : m_state) {
+        word = splitmix64(seed);
+    }
+}
+
+uint64_t Rng::next()
+{
+    uint64_t const result = rotl(m_state[1] * 5, 7) * 9;
+    uint64_t const t = m_state[1] << 17;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = rotl(m_state[3], 45);
+
+    return result;
+}
+
+int Rng::nextInt(int min, int max)
+{
+    // Lemire's multiply-shift: map 32 random bits onto the range, rejecting the
+    // few low products that would make some values more likely than others
+    uint32_t const range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min) + 1;
+    if (range == 0) {
+        return static_cast<int>(next() >> 32); // the full int range
+    }
+
+    uint64_t product = (next() >> 32) * range;
+
+    if (static_cast<uint32_t>(product) < range) {
+        uint32_t const threshold = -range % range;
+        while (static_cast<uint32_t>(product) < threshold) {
+            product = (next() >> 32) * range;
+        }
+    }
+
+    return static_cast<int>(static_cast<uint32_t>(min) + static_cast<uint32_t>(product >> 32));
+}
+
+double Rng::nextDouble(double min, double max)
+{
+    // top 53 bits fill a double's mantissa exactly
+    double const unit = (next() >> 11) * 0x1.0p-53;
+    return min + unit * (max - min);
+}
+
+void Rng::fillInt(int* out, size_t n, int min, int max)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = nextInt(min, max);
+    }
+}
+
+void Rng::fillDouble(double* out, size_t n, double min, double max)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = nextDouble(min, max);
+    }
+}
+
+void seed_random(uint64_t seed)
+{
+    g_seed = seed;
+    g_nextThread = 0;
+    g_generation++;
+}
+
+uint64_t get_random_seed() { return g_seed; }
+
+Rng& thread_rng()
+{
+    static thread_local Rng rng;
+    static thread_local uint64_t generation = ~uint64_t(0);
+
+    if (generation != g_generation) {
+        generation = g_generation;
+        uint64_t stream = g_nextThread++;
+        rng.seed(g_seed ^ splitmix64(stream));
+    }
+
+    return rng;
+}
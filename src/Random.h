@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/// xoshiro256** generator: 32 bytes of state, a handful of shifts and
+/// multiplies per draw, and no shared state, so every thread can own one.
+class Rng {
+public:
+    /// expand seed into the full state with splitmix64, as the xoshiro authors recommend
+    explicit Rng(uint64_t seed = 0);
+
+    void seed(uint64_t seed);
+    uint64_t next();
+
+    /// uniform integer in [min, max], without modulo bias
+    int nextInt(int min, int max);
+
+    /// uniform double in [min, max)
+    double nextDouble(double min, double max);
+
+    /// fill out[0, n) with nextInt(min, max) / nextDouble(min, max)
+    void fillInt(int* out, size_t n, int min, int max);
+    void fillDouble(double* out, size_t n, double min, double max);
+
+private:
+    uint64_t m_state[4];
+};
+
+/// reseed every thread's generator; thread k (in order of first use) draws from
+/// the stream seeded by seed and k, so a run with the same seed replays exactly
+void seed_random(uint64_t seed);
+
+/// seed the current run was started with
+uint64_t get_random_seed();
+
+/// the calling thread's generator, (re)seeded on first use after seed_random()
+Rng& thread_rng();
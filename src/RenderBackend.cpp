@@ -0,0 +1,36 @@
+#include "RenderBackend.h"
+#include "ParticleSystem.h"
+#include "SoftwareRasterizer.h"
+
+#include <stdexcept>
+
+SfmlBackend::SfmlBackend(sf::RenderWindow& window)
+    : m_window(window)
+{
+}
+
+void SfmlBackend::beginFrame(sf::Vector2u) { m_window.clear(); }
+
+void SfmlBackend::drawParticles(ParticleSystem const& particles, sf::Transform const& transform)
+{
+    m_window.draw(particles, transform);
+}
+
+void SfmlBackend::endFrame() { m_window.display(); }
+
+std::unique_ptr<RenderBackend> make_render_backend(
+    std::string const& name, sf::RenderWindow* window, ThreadPool& pool)
+{
+    if (name == "sfml") {
+        if (!window) {
+            return nullptr;
+        }
+        return std::make_unique<SfmlBackend>(*window);
+    }
+
+    if (name == "cpu") {
+        return std::make_unique<SoftwareRasterizer>(pool, window);
+    }
+
+    throw std::runtime_error("Error: unknown renderer " + name);
+}
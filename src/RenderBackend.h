@@ -0,0 +1,57 @@
+#pragma once
+#include "ThreadPool.h"
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ParticleSystem;
+
+/// An RGBA8 image, row-major from the top row. sf::Color is four bytes, so
+/// pixels.data() is also the R, G, B, A byte layout sf::Texture and image files expect.
+struct Framebuffer {
+    unsigned width = 0;
+    unsigned height = 0;
+    std::vector<sf::Color> pixels;
+
+    sf::Color at(unsigned x, unsigned y) const { return pixels[y * width + x]; }
+};
+
+/// Where Engine::draw sends each frame. Config's renderer key picks the backend:
+/// "sfml" draws through the window with OpenGL, "cpu" rasterizes on the thread
+/// pool (SoftwareRasterizer) and so also works without a display.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    /// start a frame of size pixels, cleared to black
+    virtual void beginFrame(sf::Vector2u size) = 0;
+
+    /// draw particles, mapped from world space onto the frame by transform
+    virtual void drawParticles(ParticleSystem const& particles, sf::Transform const& transform)
+        = 0;
+
+    /// finish the frame and show it, if there is a window to show it in
+    virtual void endFrame() = 0;
+
+    /// the last finished frame, if this backend renders into memory; nullptr otherwise
+    virtual Framebuffer const* getFramebuffer() const { return nullptr; }
+};
+
+/// draws straight into an SFML window
+class SfmlBackend : public RenderBackend {
+public:
+    explicit SfmlBackend(sf::RenderWindow& window);
+
+    void beginFrame(sf::Vector2u size) override;
+    void drawParticles(ParticleSystem const& particles, sf::Transform const& transform) override;
+    void endFrame() override;
+
+private:
+    sf::RenderWindow& m_window;
+};
+
+/// the backend called name, presenting to window, or nullptr when there is nothing
+/// to draw into (sfml without a window); throws std::runtime_error for an unknown name
+std::unique_ptr<RenderBackend> make_render_backend(
+    std::string const& name, sf::RenderWindow* window, ThreadPool& pool);
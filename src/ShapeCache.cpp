@@ -0,0 +1,37 @@
+#include "ShapeCache.h"
+
+#include <cmath>
+#include <stdexcept>
+
+ShapeCache::ShapeCache()
+    : m_shapes(MAX_POINTS + 1)
+{
+    for (int numPoints = 2; numPoints <= MAX_POINTS; numPoints++) {
+        Shape& shape = m_shapes[numPoints];
+        double const dTheta = 2 * M_PI / (numPoints - 1);
+
+        shape.numPoints = numPoints;
+
+        for (int j = 0; j < numPoints; j++) {
+            float const x = std::cos(j * dTheta);
+            float const y = std::sin(j * dTheta);
+
+            if (j % 2) {
+                shape.innerX[j / 2] = x;
+                shape.innerY[j / 2] = y;
+            } else {
+                shape.outerX[j / 2] = x;
+                shape.outerY[j / 2] = y;
+            }
+        }
+    }
+}
+
+ShapeCache::Shape const& ShapeCache::get(int numPoints) const
+{
+    if (numPoints < 2 || numPoints > MAX_POINTS) {
+        throw std::domain_error("Error: unsupported star point count");
+    }
+
+    return m_shapes[numPoints];
+}
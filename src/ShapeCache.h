@@ -0,0 +1,35 @@
+#pragma once
+#include <array>
+#include <vector>
+
+/// Unit-radius star outlines shared by every particle with the same point count.
+/// Point j of an n-point star lies at angle j * 2pi / (n - 1); even points sit on
+/// the outer radius and odd points on the inner one, so each ring is stored
+/// separately and a particle's own radii are applied when its vertices are built.
+class ShapeCache {
+public:
+    static int constexpr MAX_POINTS = 33;
+    static int constexpr RING_CAPACITY = (MAX_POINTS + 1) / 2;
+
+    struct Shape {
+        int numPoints = 0;
+
+        // unit directions of the even (outer) and odd (inner) outline points
+        std::array<float, RING_CAPACITY> outerX {};
+        std::array<float, RING_CAPACITY> outerY {};
+        std::array<float, RING_CAPACITY> innerX {};
+        std::array<float, RING_CAPACITY> innerY {};
+
+        int outerCount() const { return (numPoints + 1) / 2; }
+        int innerCount() const { return numPoints / 2; }
+    };
+
+    /// builds every shape from 2 to MAX_POINTS points up front
+    ShapeCache();
+
+    /// shape with numPoints outline points, 2 <= numPoints <= MAX_POINTS
+    Shape const& get(int numPoints) const;
+
+private:
+    std::vector<Shape> m_shapes; // indexed by point count
+};
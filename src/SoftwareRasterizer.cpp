@@ -0,0 +1,338 @@
+#include "SoftwareRasterizer.h"
+#include "ParticleSystem.h"
+#include "../lib/Timer.h"
+#include "grow.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+int constexpr ONE = 1 << SoftwareRasterizer::SUBPIXEL_BITS; // a pixel in fixed point
+int constexpr HALF = ONE / 2;                               // pixel centers are at + HALF
+float constexpr MAX_COORDINATE = 1 << 20; // pixels; keeps edge products well inside int64
+
+/// twice the signed area of (a, b, p); positive when p is on the inner side of a -> b
+template <class V> int64_t edge(V const& a, V const& b, int64_t px, int64_t py)
+{
+    return int64_t(b.x - a.x) * (py - a.y) - int64_t(b.y - a.y) * (px - a.x);
+}
+
+/// top and left edges own the pixels exactly on them; the others get a -1 bias
+/// so those pixels fall outside. Winding is fixed so the interior is on the right.
+template <class V> int64_t fill_bias(V const& a, V const& b)
+{
+    bool const top = a.y == b.y && b.x > a.x;
+    bool const left = b.y < a.y;
+    return (top || left) ? 0 : -1;
+}
+
+/// first pixel whose center is at or after the fixed-point coordinate v
+int first_pixel(int64_t v)
+{
+    int64_t const shifted = v - HALF + ONE - 1;
+    return static_cast<int>(shifted >= 0 ? shifted / ONE : -((-shifted + ONE - 1) / ONE));
+}
+
+sf::Uint8 blend_channel(int src, int dst, int alpha)
+{
+    return static_cast<sf::Uint8>((src * alpha + dst * (255 - alpha) + 127) / 255);
+}
+
+/// sf::BlendAlpha: src over dst by src's alpha
+void blend(sf::Color& dst, sf::Color src)
+{
+    if (src.a == 255) {
+        dst = src;
+        return;
+    }
+    if (src.a == 0) {
+        return;
+    }
+    dst.r = blend_channel(src.r, dst.r, src.a);
+    dst.g = blend_channel(src.g, dst.g, src.a);
+    dst.b = blend_channel(src.b, dst.b, src.a);
+    dst.a = static_cast<sf::Uint8>(src.a + (dst.a * (255 - src.a) + 127) / 255);
+}
+} // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(ThreadPool& pool, sf::RenderWindow* window)
+    : m_pool(pool)
+    , m_window(window)
+{
+}
+
+void SoftwareRasterizer::beginFrame(sf::Vector2u size)
+{
+    m_vertices.clear();
+
+    if (size.x == m_framebuffer.width && size.y == m_framebuffer.height) {
+        return;
+    }
+
+    m_framebuffer.width = size.x;
+    m_framebuffer.height = size.y;
+    m_framebuffer.pixels.assign(size_t(size.x) * size.y, sf::Color::Black);
+    m_tilesX = (size.x + TILE_SIZE - 1) / TILE_SIZE;
+    m_tilesY = (size.y + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+void SoftwareRasterizer::drawParticles(
+    ParticleSystem const& particles, sf::Transform const& transform)
+{
+    size_t const count = particles.buildBatch();
+    drawTriangles(particles.getBatch(), count, transform);
+}
+
+void SoftwareRasterizer::drawTriangles(
+    sf::Vertex const* vertices, size_t count, sf::Transform const& transform)
+{
+    PROFILE_SCOPE("transform");
+    count -= count % 3;
+    size_t const first = m_vertices.size();
+
+    grow_to(m_vertices, first + count);
+
+    struct Job {
+        sf::Vertex const* in;
+        ScreenVertex* out;
+        float const* m; // column-major 4x4
+    } const job { vertices, m_vertices.data() + first, transform.getMatrix() };
+
+    m_pool.parallelFor(count, 3 * 4096, [&job](size_t begin, size_t end) {
+        float const* m = job.m;
+        for (size_t i = begin; i < end; i++) {
+            sf::Vector2f const p = job.in[i].position;
+            float const x = std::clamp(m[0] * p.x + m[4] * p.y + m[12], -MAX_COORDINATE,
+                MAX_COORDINATE);
+            float const y = std::clamp(m[1] * p.x + m[5] * p.y + m[13], -MAX_COORDINATE,
+                MAX_COORDINATE);
+            job.out[i] = { static_cast<int32_t>(std::lround(x * ONE)),
+                static_cast<int32_t>(std::lround(y * ONE)), job.in[i].color };
+        }
+    });
+}
+
+void SoftwareRasterizer::endFrame()
+{
+    PROFILE_SCOPE("rasterize");
+    size_t const tileCount = size_t(m_tilesX) * m_tilesY;
+
+    size_t const slices = std::max(1u, m_pool.size());
+    if (m_bins.size() != slices || m_bins[0].offsets.size() != tileCount + 1) {
+        m_bins.resize(slices);
+        for (Bins& bins : m_bins) {
+            bins.offsets.resize(tileCount + 1);
+            bins.cursor.resize(tileCount);
+        }
+    }
+    // room for a slice of the most triangles the vertex buffer holds, each in
+    // MAX_BINNED_TILES tiles, so binning only grows with the vertex buffer
+    size_t const sliceTriangles = (m_vertices.capacity() / 3 + slices - 1) / slices;
+    for (Bins& bins : m_bins) {
+        bins.triangles.reserve(MAX_BINNED_TILES * sliceTriangles);
+        bins.large.reserve(sliceTriangles);
+    }
+
+    m_pool.parallelFor(slices, 1, [this](size_t first, size_t last) {
+        for (size_t slice = first; slice < last; slice++) {
+            binSlice(slice);
+        }
+    });
+
+    m_pool.parallelFor(tileCount, 1, [this](size_t first, size_t last) {
+        for (size_t tile = first; tile < last; tile++) {
+            fillTile(tile);
+        }
+    });
+
+    if (!m_window || m_framebuffer.pixels.empty()) {
+        return;
+    }
+
+    if (m_texture.getSize() != sf::Vector2u(m_framebuffer.width, m_framebuffer.height)) {
+        m_texture.create(m_framebuffer.width, m_framebuffer.height);
+    }
+    m_texture.update(reinterpret_cast<sf::Uint8 const*>(m_framebuffer.pixels.data()));
+    m_window->draw(sf::Sprite(m_texture));
+    m_window->display();
+}
+
+bool SoftwareRasterizer::pixelBounds(size_t triangle, int& x0, int& y0, int& x1, int& y1) const
+{
+    ScreenVertex const* v = &m_vertices[3 * triangle];
+    if (edge(v[0], v[1], v[2].x, v[2].y) == 0) {
+        return false;
+    }
+
+    x0 = std::max(0, first_pixel(std::min({ v[0].x, v[1].x, v[2].x })));
+    y0 = std::max(0, first_pixel(std::min({ v[0].y, v[1].y, v[2].y })));
+    x1 = std::min<int>(m_framebuffer.width, first_pixel(std::max({ v[0].x, v[1].x, v[2].x }) + 1));
+    y1 = std::min<int>(
+        m_framebuffer.height, first_pixel(std::max({ v[0].y, v[1].y, v[2].y }) + 1));
+    return x0 < x1 && y0 < y1;
+}
+
+void SoftwareRasterizer::binSlice(size_t slice)
+{
+    Bins& bins = m_bins[slice];
+    size_t const tileCount = bins.cursor.size();
+    size_t const triangles = m_vertices.size() / 3;
+    size_t const first = triangles * slice / m_bins.size();
+    size_t const last = triangles * (slice + 1) / m_bins.size();
+    int x0, y0, x1, y1;
+
+    // tiles the triangle's bounding box spans, 0 if it covers no pixel centers
+    auto const tilesOf = [&](size_t t) {
+        if (!pixelBounds(t, x0, y0, x1, y1)) {
+            return 0;
+        }
+        return ((x1 - 1) / TILE_SIZE - x0 / TILE_SIZE + 1)
+            * ((y1 - 1) / TILE_SIZE - y0 / TILE_SIZE + 1);
+    };
+
+    // count each tile's triangles, then lay the lists out back to back
+    std::fill(bins.cursor.begin(), bins.cursor.end(), 0);
+    for (size_t t = first; t < last; t++) {
+        int const tiles = tilesOf(t);
+        if (tiles == 0 || tiles > MAX_BINNED_TILES) {
+            continue;
+        }
+        for (int ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ty++) {
+            for (int tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; tx++) {
+                bins.cursor[ty * m_tilesX + tx]++;
+            }
+        }
+    }
+
+    uint32_t total = 0;
+    for (size_t tile = 0; tile < tileCount; tile++) {
+        bins.offsets[tile] = total;
+        total += bins.cursor[tile];
+        bins.cursor[tile] = bins.offsets[tile];
+    }
+    bins.offsets[tileCount] = total;
+
+    // within the capacity endFrame() reserved: at most MAX_BINNED_TILES per triangle
+    bins.triangles.resize(total);
+    bins.large.clear();
+
+    for (size_t t = first; t < last; t++) {
+        int const tiles = tilesOf(t);
+        if (tiles == 0) {
+            continue;
+        }
+        if (tiles > MAX_BINNED_TILES) {
+            bins.large.push_back(static_cast<uint32_t>(t));
+            continue;
+        }
+        for (int ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ty++) {
+            for (int tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; tx++) {
+                bins.triangles[bins.cursor[ty * m_tilesX + tx]++] = static_cast<uint32_t>(t);
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::fillTile(size_t tile)
+{
+    int const x0 = (tile % m_tilesX) * TILE_SIZE;
+    int const y0 = (tile / m_tilesX) * TILE_SIZE;
+    int const x1 = std::min<int>(x0 + TILE_SIZE, m_framebuffer.width);
+    int const y1 = std::min<int>(y0 + TILE_SIZE, m_framebuffer.height);
+
+    for (int y = y0; y < y1; y++) {
+        sf::Color* row = &m_framebuffer.pixels[size_t(y) * m_framebuffer.width];
+        std::fill(row + x0, row + x1, sf::Color::Black);
+    }
+
+    // slices in order, and within a slice the tile's list merged with the large
+    // triangles, so triangles land in the order they were drawn
+    for (Bins const& bins : m_bins) {
+        uint32_t i = bins.offsets[tile];
+        uint32_t const end = bins.offsets[tile + 1];
+        size_t k = 0;
+        while (i < end || k < bins.large.size()) {
+            if (k == bins.large.size() || (i < end && bins.triangles[i] < bins.large[k])) {
+                fillTriangle(bins.triangles[i++], x0, y0, x1, y1);
+            } else {
+                fillTriangle(bins.large[k++], x0, y0, x1, y1);
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::fillTriangle(size_t triangle, int x0, int y0, int x1, int y1)
+{
+    ScreenVertex a = m_vertices[3 * triangle];
+    ScreenVertex b = m_vertices[3 * triangle + 1];
+    ScreenVertex c = m_vertices[3 * triangle + 2];
+
+    int64_t area = edge(a, b, c.x, c.y);
+    if (area < 0) {
+        std::swap(b, c);
+        area = -area;
+    }
+
+    x0 = std::max(x0, first_pixel(std::min({ a.x, b.x, c.x })));
+    y0 = std::max(y0, first_pixel(std::min({ a.y, b.y, c.y })));
+    x1 = std::min(x1, first_pixel(std::max({ a.x, b.x, c.x }) + 1));
+    y1 = std::min(y1, first_pixel(std::max({ a.y, b.y, c.y }) + 1));
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    // barycentric weights: wa is the weight of a (the edge opposite it), and so on
+    int64_t const px = int64_t(x0) * ONE + HALF;
+    int64_t const py = int64_t(y0) * ONE + HALF;
+    int64_t waRow = edge(b, c, px, py) + fill_bias(b, c);
+    int64_t wbRow = edge(c, a, px, py) + fill_bias(c, a);
+    int64_t wcRow = edge(a, b, px, py) + fill_bias(a, b);
+
+    int64_t const waStepX = int64_t(b.y - c.y) * ONE;
+    int64_t const wbStepX = int64_t(c.y - a.y) * ONE;
+    int64_t const wcStepX = int64_t(a.y - b.y) * ONE;
+    int64_t const waStepY = int64_t(c.x - b.x) * ONE;
+    int64_t const wbStepY = int64_t(a.x - c.x) * ONE;
+    int64_t const wcStepY = int64_t(b.x - a.x) * ONE;
+
+    bool const flat = a.color == b.color && a.color == c.color;
+    float const invArea = 1.f / area;
+    float const base[4]
+        = { float(a.color.r), float(a.color.g), float(a.color.b), float(a.color.a) };
+    float const towardB[4] = { float(b.color.r - a.color.r), float(b.color.g - a.color.g),
+        float(b.color.b - a.color.b), float(b.color.a - a.color.a) };
+    float const towardC[4] = { float(c.color.r - a.color.r), float(c.color.g - a.color.g),
+        float(c.color.b - a.color.b), float(c.color.a - a.color.a) };
+
+    for (int y = y0; y < y1; y++) {
+        sf::Color* row = &m_framebuffer.pixels[size_t(y) * m_framebuffer.width];
+        int64_t wa = waRow;
+        int64_t wb = wbRow;
+        int64_t wc = wcRow;
+
+        for (int x = x0; x < x1; x++) {
+            if ((wa | wb | wc) >= 0) {
+                if (flat) {
+                    blend(row[x], a.color);
+                } else {
+                    float const tb = wb * invArea;
+                    float const tc = wc * invArea;
+                    sf::Uint8 channels[4];
+                    for (int k = 0; k < 4; k++) {
+                        channels[k] = static_cast<sf::Uint8>(
+                            std::clamp(base[k] + tb * towardB[k] + tc * towardC[k], 0.f, 255.f)
+                            + 0.5f);
+                    }
+                    blend(row[x], sf::Color(channels[0], channels[1], channels[2], channels[3]));
+                }
+            }
+            wa += waStepX;
+            wb += wbStepX;
+            wc += wcStepX;
+        }
+
+        waRow += waStepY;
+        wbRow += wbStepY;
+        wcRow += wcStepY;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "RenderBackend.h"
+#include "ThreadPool.h"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+/// Tile-based CPU rasterizer for sf::Triangles lists.
+///
+/// Triangles are queued by drawTriangles() and rendered by endFrame() in two
+/// passes over the thread pool:
+///  1. binning: the triangle list is cut into one slice per thread and each
+///     slice appends its triangles to per-tile lists, by bounding box; the
+///     few whose box spans more than MAX_BINNED_TILES tiles go to one list
+///     every tile reads instead, so bin storage is bounded by the vertex buffer's
+///     capacity and a warmed-up frame never allocates, whatever the triangles cover;
+///  2. filling: every TILE_SIZE square tile is cleared and filled from its
+///     lists, slice by slice, so triangles land in submission order and no two
+///     threads ever write the same pixel.
+///
+/// It follows OpenGL's rules, so frames match the sfml backend closely: vertices
+/// snap to 1/256 pixel, pixels are sampled at their centers, shared edges belong
+/// to exactly one triangle (top-left rule), colors are interpolated linearly
+/// across each triangle and alpha blended as sf::BlendAlpha does.
+class SoftwareRasterizer : public RenderBackend {
+public:
+    static int constexpr TILE_SIZE = 64;    // pixels per side
+    static int constexpr SUBPIXEL_BITS = 8; // vertex precision, as OpenGL hardware
+    static int constexpr MAX_BINNED_TILES = 4; // most tiles one triangle is binned into
+
+    /// render on pool's threads; each finished frame is shown in window if there is one
+    explicit SoftwareRasterizer(ThreadPool& pool, sf::RenderWindow* window = nullptr);
+
+    void beginFrame(sf::Vector2u size) override;
+    void drawParticles(ParticleSystem const& particles, sf::Transform const& transform) override;
+    void endFrame() override;
+
+    /// queue count / 3 triangles, mapped onto the frame by transform
+    void drawTriangles(sf::Vertex const* vertices, size_t count, sf::Transform const& transform);
+
+    /// the last frame endFrame() rendered
+    Framebuffer const* getFramebuffer() const override { return &m_framebuffer; }
+
+private:
+    struct ScreenVertex {
+        int32_t x; // fixed point, SUBPIXEL_BITS fraction bits
+        int32_t y;
+        sf::Color color;
+    };
+
+    ThreadPool& m_pool;
+    sf::RenderWindow* m_window;
+    sf::Texture m_texture; // the framebuffer's copy on the GPU when presenting
+
+    Framebuffer m_framebuffer;
+    int m_tilesX = 0;
+    int m_tilesY = 0;
+
+    std::vector<ScreenVertex> m_vertices; // this frame's triangles, three vertices each
+
+    // one slice's triangle indices, grouped by tile with a counting sort so each
+    // tile's list is the contiguous range [offsets[tile], offsets[tile + 1])
+    struct Bins {
+        std::vector<uint32_t> offsets; // tile count + 1 entries
+        std::vector<uint32_t> cursor;
+        std::vector<uint32_t> triangles;
+        std::vector<uint32_t> large; // spanning more than MAX_BINNED_TILES tiles, in order
+    };
+    std::vector<Bins> m_bins; // one per slice
+
+    /// pixels [x0, x1) x [y0, y1) whose centers the triangle's bounding box covers;
+    /// false if it covers none, or the triangle has no area
+    bool pixelBounds(size_t triangle, int& x0, int& y0, int& x1, int& y1) const;
+
+    /// bin the triangles of slice
+    void binSlice(size_t slice);
+
+    /// clear tile and fill it from every slice's bin and large triangles
+    void fillTile(size_t tile);
+
+    /// fill the part of triangle inside the pixel rectangle [x0, x1) x [y0, y1)
+    void fillTriangle(size_t triangle, int x0, int y0, int x1, int y1);
+};
@@ -0,0 +1,68 @@
+#include "SpatialHash.h"
+#include "grow.h"
+
+namespace {
+size_t constexpr BUCKET_GRAIN = 4096; // points per parallel chunk
+uint32_t constexpr MIN_BUCKETS = 64;
+} // namespace
+
+void SpatialHash::reserve(size_t count)
+{
+    // the table only grows, so a population that shrinks and recovers never reallocates it
+    uint32_t buckets = std::max(m_bucketMask + 1, MIN_BUCKETS);
+    while (buckets < 2 * count) {
+        buckets *= 2;
+    }
+    m_bucketMask = buckets - 1;
+    grow_to(m_bucketStart, size_t(buckets) + 1);
+    grow_to(m_bucket, count);
+    grow_to(m_order, count);
+    grow_to(m_sortedX, count);
+    grow_to(m_sortedY, count);
+}
+
+void SpatialHash::build(float const* xs, float const* ys, size_t count, ThreadPool* pool)
+{
+    reserve(count);
+    uint32_t const buckets = m_bucketMask + 1;
+    m_bucket.resize(count);
+    m_order.resize(count);
+    m_sortedX.resize(count);
+    m_sortedY.resize(count);
+
+    struct Job {
+        SpatialHash& self;
+        float const* xs;
+        float const* ys;
+    } const job { *this, xs, ys };
+    ThreadPool::RangeFn const hashRange = [&job](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            SpatialHash& self = job.self;
+            self.m_bucket[i] = self.bucketOf(self.cellOf(job.xs[i]), self.cellOf(job.ys[i]));
+        }
+    };
+    if (pool) {
+        pool->parallelFor(count, BUCKET_GRAIN, hashRange);
+    } else {
+        hashRange(0, count);
+    }
+
+    // counting sort: bucket sizes, then their starts, then scatter in input order
+    std::fill(m_bucketStart.begin(), m_bucketStart.end(), 0);
+    for (size_t i = 0; i < count; i++) {
+        m_bucketStart[m_bucket[i] + 1]++;
+    }
+    for (uint32_t b = 0; b < buckets; b++) {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+    // m_bucketStart[b] doubles as bucket b's write cursor and ends up at bucket b's
+    // end, the next bucket's start, so shifting the table up one entry restores it
+    for (size_t i = 0; i < count; i++) {
+        uint32_t const k = m_bucketStart[m_bucket[i]]++;
+        m_order[k] = static_cast<uint32_t>(i);
+        m_sortedX[k] = xs[i];
+        m_sortedY[k] = ys[i];
+    }
+    std::copy_backward(m_bucketStart.begin(), m_bucketStart.end() - 1, m_bucketStart.end());
+    m_bucketStart[0] = 0;
+}
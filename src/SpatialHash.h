@@ -0,0 +1,95 @@
+#pragma once
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/// Uniform grid over an unbounded plane for fixed-radius neighbour queries.
+///
+/// Square cells of getCellSize() are hashed into a power-of-two bucket table,
+/// about two buckets per point, so the grid needs no bounds and stays sparse.
+/// build() counting-sorts the points by bucket: each bucket's points end up in
+/// one contiguous range of the sorted arrays, and a query walks the few ranges
+/// around it instead of every point. Cells sharing a bucket only add candidates
+/// that callers reject by distance anyway.
+///
+/// Rebuilt from scratch every frame; it keeps its capacity, growing geometrically,
+/// so a steady population builds without allocating.
+class SpatialHash {
+public:
+    // queries span at most this many cells per axis, so cells may be as small as a
+    // third of the query radius
+    static int constexpr MAX_SPAN = 8;
+
+    explicit SpatialHash(float cellSize = 16)
+        : m_cellSize(cellSize)
+    {
+    }
+
+    void setCellSize(float cellSize) { m_cellSize = cellSize; }
+    float getCellSize() const { return m_cellSize; }
+
+    /// make room for builds of up to count points without allocating
+    void reserve(size_t count);
+
+    /// sort the count points (xs[i], ys[i]) into cells, computing their buckets on
+    /// pool's threads if there is one
+    void build(float const* xs, float const* ys, size_t count, ThreadPool* pool = nullptr);
+
+    size_t size() const { return m_order.size(); }
+
+    /// the points in bucket order; sorted point k is build()'s point order()[k]
+    float const* sortedX() const { return m_sortedX.data(); }
+    float const* sortedY() const { return m_sortedY.data(); }
+    uint32_t const* order() const { return m_order.data(); }
+
+    /// call fn(k) for every sorted point k in the cells within radius of (x, y) on
+    /// both axes, each point once; radius must be at most 3 cells
+    template <class Fn> void forEachCandidate(float x, float y, float radius, Fn&& fn) const
+    {
+        int const x0 = cellOf(x - radius);
+        int const y0 = cellOf(y - radius);
+        int const x1 = std::min(cellOf(x + radius), x0 + MAX_SPAN - 1);
+        int const y1 = std::min(cellOf(y + radius), y0 + MAX_SPAN - 1);
+
+        // two of the cells may share a bucket; walk each bucket once
+        uint32_t visited[MAX_SPAN * MAX_SPAN];
+        int visitedCount = 0;
+
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                uint32_t const bucket = bucketOf(cx, cy);
+                if (std::find(visited, visited + visitedCount, bucket) != visited + visitedCount) {
+                    continue;
+                }
+                visited[visitedCount++] = bucket;
+
+                for (uint32_t k = m_bucketStart[bucket]; k < m_bucketStart[bucket + 1]; k++) {
+                    fn(k);
+                }
+            }
+        }
+    }
+
+private:
+    float m_cellSize;
+    uint32_t m_bucketMask = 0; // bucket count - 1
+
+    std::vector<uint32_t> m_bucketStart; // bucket count + 1 entries; a bucket is [start, next)
+    std::vector<uint32_t> m_bucket;      // per build() point
+    std::vector<uint32_t> m_order;
+    std::vector<float> m_sortedX;
+    std::vector<float> m_sortedY;
+
+    int cellOf(float v) const
+    {
+        // clamped so points flung far off still land in some cell
+        return static_cast<int>(std::fmax(std::fmin(std::floor(v / m_cellSize), 1e9f), -1e9f));
+    }
+
+    uint32_t bucketOf(int cx, int cy) const
+    {
+        return ((uint32_t(cx) * 73856093u) ^ (uint32_t(cy) * 19349663u)) & m_bucketMask;
+    }
+};
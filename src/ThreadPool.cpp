@@ -0,0 +1,127 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : m_job(nullptr)
+    , m_count(0)
+    , m_grainSize(1)
+    , m_generation(0)
+    , m_stopping(false)
+    , m_remaining(0)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threadCount; i++) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+
+    for (unsigned i = 1; i < threadCount; i++) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grainSize, RangeFn const& fn)
+{
+    grainSize = std::max<size_t>(grainSize, 1);
+
+    if (m_workers.empty() || count <= grainSize) {
+        for (size_t first = 0; first < count; first += grainSize) {
+            fn(first, std::min(count, first + grainSize));
+        }
+        return;
+    }
+
+    size_t const chunks = (count + grainSize - 1) / grainSize;
+    m_remaining = chunks;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &fn;
+        m_count = count;
+        m_grainSize = grainSize;
+
+        for (size_t i = 0; i < m_queues.size(); i++) {
+            Queue& queue = *m_queues[i];
+            std::lock_guard<std::mutex> queueLock(queue.mutex);
+            queue.head = chunks * i / m_queues.size();
+            queue.tail = chunks * (i + 1) / m_queues.size();
+        }
+
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    while (runOne(0)) { }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_remaining == 0; });
+    m_job = nullptr;
+}
+
+bool ThreadPool::runOne(unsigned self)
+{
+    size_t chunk = 0;
+    bool found = false;
+
+    for (unsigned offset = 0; offset < size() && !found; offset++) {
+        Queue& queue = *m_queues[(self + offset) % size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.empty()) {
+            continue;
+        }
+
+        // owners take from the front, thieves from the back
+        chunk = offset == 0 ? queue.head++ : --queue.tail;
+        found = true;
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    size_t const first = chunk * m_grainSize;
+    (*m_job)(first, std::min(m_count, first + m_grainSize));
+
+    if (--m_remaining == 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done.notify_all();
+    }
+
+    return true;
+}
+
+void ThreadPool::workerLoop(unsigned self)
+{
+    size_t seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+
+            if (m_stopping) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        while (runOne(self)) { }
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Persistent pool of worker threads with per-thread work-stealing queues.
+/// parallelFor splits an index range into chunks and deals each queue a contiguous
+/// run of them; a thread that drains its own queue steals from the back of the others.
+/// The calling thread works as queue 0, so a pool of size 1 runs everything inline.
+class ThreadPool {
+public:
+    /// std::function stores captures of up to 16 bytes inline and heap-allocates
+    /// larger ones, so callers on allocation-free paths gather their state in a
+    /// struct and capture only a reference to it
+    using RangeFn = std::function<void(size_t first, size_t last)>;
+
+    /// threadCount includes the calling thread; 0 means hardware concurrency
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(m_queues.size()); }
+
+    /// call fn on disjoint [first, last) chunks covering [0, count) of at most
+    /// grainSize items each, and return once every chunk has finished
+    void parallelFor(size_t count, size_t grainSize, RangeFn const& fn);
+
+private:
+    // a queue is just the chunk indices [head, tail), so dealing a job of any
+    // size stores nothing and never allocates
+    struct Queue {
+        std::mutex mutex;
+        size_t head = 0;
+        size_t tail = 0;
+
+        bool empty() const { return head == tail; }
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    RangeFn const* m_job;
+    size_t m_count;     // the job's index range is [0, m_count)
+    size_t m_grainSize; // chunk k is [k * m_grainSize, (k + 1) * m_grainSize)
+    size_t m_generation;
+    bool m_stopping;
+    std::atomic<size_t> m_remaining;
+
+    /// run one chunk from queue self, or stolen from another; false when all are empty
+    bool runOne(unsigned self);
+    void workerLoop(unsigned self);
+};
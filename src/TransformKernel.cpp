@@ -0,0 +1,179 @@
+#include "TransformKernel.h"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define TRANSFORM_KERNEL_X86
+#    include <immintrin.h>
+#endif
+
+namespace Matrices {
+
+namespace {
+
+    using KernelFn
+        = void (*)(AffineMatrix const&, float const*, float const*, int, sf::Vertex*, int);
+
+    // Plain coefficients, loaded once per call so the loops below stay register-only
+    struct Coefficients {
+        float a00, a01, tx, a10, a11, ty;
+
+        Coefficients(AffineMatrix const& t)
+            : a00(t(0, 0))
+            , a01(t(0, 1))
+            , tx(t(0, 2))
+            , a10(t(1, 0))
+            , a11(t(1, 1))
+            , ty(t(1, 2))
+        {
+        }
+    };
+
+    void transform_scalar_from(Coefficients const& c, float const* xs, float const* ys, int first,
+        int n, sf::Vertex* vertices, int stride)
+    {
+        for (int j = first; j < n; j++) {
+            vertices[j * stride].position.x = c.a00 * xs[j] + c.a01 * ys[j] + c.tx;
+            vertices[j * stride].position.y = c.a10 * xs[j] + c.a11 * ys[j] + c.ty;
+        }
+    }
+
+    void transform_scalar(AffineMatrix const& t, float const* xs, float const* ys, int n,
+        sf::Vertex* vertices, int stride)
+    {
+        transform_scalar_from(Coefficients(t), xs, ys, 0, n, vertices, stride);
+    }
+
+#ifdef TRANSFORM_KERNEL_X86
+
+    // store four interleaved (x, y) pairs into every stride-th vertex position
+    inline void store_positions_sse(__m128 xy01, __m128 xy23, sf::Vertex* vertices, int stride)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(&vertices[0].position), xy01);
+        _mm_storeh_pi(reinterpret_cast<__m64*>(&vertices[stride].position), xy01);
+        _mm_storel_pi(reinterpret_cast<__m64*>(&vertices[2 * stride].position), xy23);
+        _mm_storeh_pi(reinterpret_cast<__m64*>(&vertices[3 * stride].position), xy23);
+    }
+
+    __attribute__((target("sse2"))) void transform_sse2(AffineMatrix const& t, float const* xs,
+        float const* ys, int n, sf::Vertex* vertices, int stride)
+    {
+        Coefficients const c(t);
+        __m128 const a00 = _mm_set1_ps(c.a00), a01 = _mm_set1_ps(c.a01), tx = _mm_set1_ps(c.tx);
+        __m128 const a10 = _mm_set1_ps(c.a10), a11 = _mm_set1_ps(c.a11), ty = _mm_set1_ps(c.ty);
+
+        int j = 0;
+        for (; j + 4 <= n; j += 4) {
+            __m128 const x0 = _mm_loadu_ps(xs + j);
+            __m128 const y0 = _mm_loadu_ps(ys + j);
+            __m128 const x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a00, x0), _mm_mul_ps(a01, y0)), tx);
+            __m128 const y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a10, x0), _mm_mul_ps(a11, y0)), ty);
+
+            store_positions_sse(
+                _mm_unpacklo_ps(x, y), _mm_unpackhi_ps(x, y), vertices + j * stride, stride);
+        }
+
+        transform_scalar_from(c, xs, ys, j, n, vertices, stride);
+    }
+
+    __attribute__((target("avx2"))) void transform_avx2(AffineMatrix const& t, float const* xs,
+        float const* ys, int n, sf::Vertex* vertices, int stride)
+    {
+        Coefficients const c(t);
+        __m256 const a00 = _mm256_set1_ps(c.a00), a01 = _mm256_set1_ps(c.a01);
+        __m256 const a10 = _mm256_set1_ps(c.a10), a11 = _mm256_set1_ps(c.a11);
+        __m256 const tx = _mm256_set1_ps(c.tx), ty = _mm256_set1_ps(c.ty);
+
+        int j = 0;
+        for (; j + 8 <= n; j += 8) {
+            __m256 const x0 = _mm256_loadu_ps(xs + j);
+            __m256 const y0 = _mm256_loadu_ps(ys + j);
+            __m256 const x
+                = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a00, x0), _mm256_mul_ps(a01, y0)), tx);
+            __m256 const y
+                = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a10, x0), _mm256_mul_ps(a11, y0)), ty);
+
+            // unpack works per 128-bit lane: lo = (0, 1 | 4, 5), hi = (2, 3 | 6, 7)
+            __m256 const lo = _mm256_unpacklo_ps(x, y);
+            __m256 const hi = _mm256_unpackhi_ps(x, y);
+            store_positions_sse(_mm256_castps256_ps128(lo), _mm256_castps256_ps128(hi),
+                vertices + j * stride, stride);
+            store_positions_sse(_mm256_extractf128_ps(lo, 1), _mm256_extractf128_ps(hi, 1),
+                vertices + (j + 4) * stride, stride);
+        }
+
+        transform_scalar_from(c, xs, ys, j, n, vertices, stride);
+    }
+
+#endif
+
+    KernelFn kernel_for(SimdLevel level)
+    {
+        switch (level) {
+#ifdef TRANSFORM_KERNEL_X86
+        case SimdLevel::Avx2:
+            return transform_avx2;
+        case SimdLevel::Sse2:
+            return transform_sse2;
+#endif
+        default:
+            return transform_scalar;
+        }
+    }
+
+    SimdLevel& active_level()
+    {
+        static SimdLevel level = detect_simd_level();
+        return level;
+    }
+
+    KernelFn& active_kernel()
+    {
+        static KernelFn kernel = kernel_for(active_level());
+        return kernel;
+    }
+
+} // namespace
+
+SimdLevel detect_simd_level()
+{
+#ifdef TRANSFORM_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::Avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::Sse2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel get_simd_level() { return active_level(); }
+
+SimdLevel set_simd_level(SimdLevel level)
+{
+    active_level() = std::min(level, detect_simd_level());
+    active_kernel() = kernel_for(active_level());
+    return active_level();
+}
+
+char const* to_string(SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Sse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+void transform_points_to_vertices(AffineMatrix const& t, float const* xs, float const* ys, int n,
+    sf::Vertex* vertices, int vertexStride)
+{
+    active_kernel()(t, xs, ys, n, vertices, vertexStride);
+}
+
+} // namespace Matrices
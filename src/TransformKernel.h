@@ -0,0 +1,26 @@
+#pragma once
+#include "Matrices.h"
+#include <SFML/Graphics.hpp>
+
+namespace Matrices {
+
+/// instruction sets the vertex kernels can run on, slowest first
+enum class SimdLevel { Scalar, Sse2, Avx2 };
+
+/// best level this CPU supports
+SimdLevel detect_simd_level();
+
+/// level used by the transform kernels, detect_simd_level() unless overridden
+SimdLevel get_simd_level();
+
+/// force a level, clamped to what the CPU supports; returns the level in effect
+SimdLevel set_simd_level(SimdLevel level);
+
+char const* to_string(SimdLevel level);
+
+/// write t applied to each of the n points in xs and ys into
+/// vertices[j * vertexStride].position
+void transform_points_to_vertices(AffineMatrix const& t, float const* xs, float const* ys, int n,
+    sf::Vertex* vertices, int vertexStride = 1);
+
+} // namespace Matrices
@@ -0,0 +1,184 @@
+#include "config.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+std::string trim(std::string const& s)
+{
+    size_t const first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return "";
+    }
+    return s.substr(first, s.find_last_not_of(" \t\r") - first + 1);
+}
+
+[[noreturn]] void invalid(std::string const& key, std::string const& value)
+{
+    throw std::runtime_error("Error: invalid value '" + value + "' for " + key);
+}
+
+double parse_number(std::string const& key, std::string const& value, double min, double max)
+{
+    size_t used = 0;
+    double parsed = 0;
+    try {
+        parsed = std::stod(value, &used);
+    } catch (std::exception const&) {
+        invalid(key, value);
+    }
+
+    if (used != value.size() || !std::isfinite(parsed) || parsed < min || parsed > max) {
+        invalid(key, value);
+    }
+    return parsed;
+}
+
+/// the whitespace-separated numbers of value; there must be between min and max of them
+std::vector<float> parse_numbers(std::string const& key, std::string const& value, size_t min,
+    size_t max)
+{
+    std::istringstream words(value);
+    std::vector<float> numbers;
+    for (std::string word; words >> word;) {
+        numbers.push_back(parse_number(key, word, -1e7, 1e7));
+    }
+
+    if (numbers.size() < min || numbers.size() > max) {
+        invalid(key, value);
+    }
+    return numbers;
+}
+} // namespace
+
+uint64_t parse_integer(std::string const& key, std::string const& value, uint64_t min,
+    uint64_t max)
+{
+    // digits only: stoull alone would skip leading spaces and wrap "-1" around
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+        invalid(key, value);
+    }
+    uint64_t parsed = 0;
+    try {
+        parsed = std::stoull(value);
+    } catch (std::exception const&) {
+        invalid(key, value);
+    }
+
+    if (parsed < min || parsed > max) {
+        invalid(key, value);
+    }
+    return parsed;
+}
+
+void Config::set(std::string const& key, std::string const& value)
+{
+    if (key == "window-title") {
+        windowTitle = value;
+    } else if (key == "window-width") {
+        windowWidth = parse_integer(key, value, 1, 16384);
+    } else if (key == "window-height") {
+        windowHeight = parse_integer(key, value, 1, 16384);
+    } else if (key == "target-fps") {
+        targetFps = parse_integer(key, value, 1, 1000);
+    } else if (key == "particles-per-second") {
+        particlesPerSecond = parse_integer(key, value, 0, 100'000'000);
+    } else if (key == "seconds-per-rainbow-cycle") {
+        secondsPerRainbowCycle = parse_integer(key, value, 1, 3600);
+    } else if (key == "gravity") {
+        gravity = parse_number(key, value, -1e6, 1e6);
+    } else if (key == "ttl") {
+        ttl = parse_number(key, value, 1e-3, 3600);
+    } else if (key == "scale") {
+        scale = parse_number(key, value, 1e-3, 1);
+    } else if (key == "interaction-radius") {
+        interactionRadius = parse_number(key, value, 0, 1e4);
+    } else if (key == "interaction-cell") {
+        interactionCell = parse_number(key, value, 0, 1e4);
+    } else if (key == "repulsion") {
+        repulsion = parse_number(key, value, -1e7, 1e7);
+    } else if (key == "cohesion") {
+        cohesion = parse_number(key, value, -1e7, 1e7);
+    } else if (key == "collide-edges") {
+        collideEdges = parse_integer(key, value, 0, 1);
+    } else if (key == "restitution") {
+        restitution = parse_number(key, value, 0, 1);
+    } else if (key == "attractor" || key == "vortex") {
+        std::vector<float> const n = parse_numbers(key, value, 4, 4);
+        if (n[3] <= 0) {
+            invalid(key, value);
+        }
+        forces.push_back(key == "attractor" ? ForceSource::attractor({ n[0], n[1] }, n[2], n[3])
+                                            : ForceSource::vortex({ n[0], n[1] }, n[2], n[3]));
+    } else if (key == "wind") {
+        std::vector<float> const n = parse_numbers(key, value, 2, 2);
+        forces.push_back(ForceSource::wind({ n[0], n[1] }));
+    } else if (key == "turbulence") {
+        std::vector<float> const n = parse_numbers(key, value, 2, 3);
+        if (n[1] <= 0 || (n.size() == 3 && (n[2] < 0 || n[2] != std::floor(n[2])))) {
+            invalid(key, value);
+        }
+        forces.push_back(ForceSource::turbulence(
+            n[0], n[1], n.size() == 3 ? static_cast<uint32_t>(n[2]) : 0));
+    } else if (key == "field-cell") {
+        fieldCell = parse_number(key, value, 1, 1e4);
+    } else if (key == "pool-capacity") {
+        poolCapacity = parse_integer(key, value, 0, 1'000'000'000);
+    } else if (key == "removal-policy") {
+        if (value != "stable" && value != "swap") {
+            invalid(key, value);
+        }
+        removalPolicy = value;
+    } else if (key == "threads") {
+        threadCount = parse_integer(key, value, 0, 1024);
+    } else if (key == "renderer") {
+        if (value != "sfml" && value != "cpu") {
+            invalid(key, value);
+        }
+        renderer = value;
+    } else if (key == "export-queue") {
+        exportQueue = parse_integer(key, value, 1, 64);
+    } else {
+        throw std::runtime_error("Error: unknown config key " + key);
+    }
+}
+
+void Config::load(std::string const& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Error: failed to read config " + path);
+    }
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); lineNumber++) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+
+        size_t const equals = line.find('=');
+        if (equals == std::string::npos) {
+            throw std::runtime_error(
+                "Error: expected key = value at " + path + ":" + std::to_string(lineNumber));
+        }
+        set(trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+    }
+}
+
+size_t Config::poolSize() const
+{
+    if (poolCapacity > 0) {
+        return poolCapacity;
+    }
+    return static_cast<size_t>(std::ceil(particlesPerSecond * ttl));
+}
+
+size_t Config::paletteSize() const
+{
+    long long const size = static_cast<long long>(particlesPerSecond) * secondsPerRainbowCycle;
+    return static_cast<size_t>(std::clamp(size, 2LL, static_cast<long long>(MAX_PALETTE_SIZE)));
+}
@@ -1,10 +1,73 @@
 #pragma once
+#include "ForceField.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
-std::string const WINDOW_TITLE = "Particle Project";
-constexpr int WINDOW_WIDTH = 1920;
-constexpr int WINDOW_HEIGHT = 1080;
-constexpr int TARGET_FPS = 60;
+/// Startup settings. The defaults are the values the project has always shipped with.
+///
+/// Each field has a key, e.g. particles-per-second. A config file holds one
+/// `key = value` per line, with # starting a comment; on the command line the
+/// same key is a flag, `--particles-per-second 3000`, so spawn rates and pool
+/// sizes can be swept without rebuilding.
+struct Config {
+    // rainbow palettes longer than this cycle faster than seconds-per-rainbow-cycle
+    static size_t constexpr MAX_PALETTE_SIZE = 1 << 20;
 
-constexpr int PARTICLES_PER_SECOND = 300;
-constexpr int SECONDS_PER_RAINBOW_CYCLE = 5;
+    std::string windowTitle = "Particle Project"; // window-title
+    int windowWidth = 1920;                        // window-width
+    int windowHeight = 1080;                       // window-height
+    int targetFps = 60;                            // target-fps; also the headless dt
+
+    int particlesPerSecond = 300;   // particles-per-second
+    int secondsPerRainbowCycle = 5; // seconds-per-rainbow-cycle
+
+    float gravity = 1000; // gravity, world units / s^2
+    float ttl = 2.0;      // ttl, seconds the slowest particle lives
+    float scale = 0.99f;  // scale, shrink factor per frame at target-fps
+
+    // particle interactions (see ParticleInteractions.h); off by default
+    float interactionRadius = 0; // interaction-radius, world units; 0 disables the forces
+    float interactionCell = 0;   // interaction-cell, spatial hash cell size; 0 uses the radius
+    float repulsion = 0;         // repulsion, world units / s^2
+    float cohesion = 0;          // cohesion, world units / s^2
+    bool collideEdges = false;   // collide-edges, 1 to bounce particles off the window edges
+    float restitution = 0.6f;    // restitution, share of speed a bounce keeps
+
+    // force fields (see ForceField.h); each of these keys adds a source, at world
+    // coordinates from the window center, y up, with strengths in world units / s^2:
+    //   attractor = X Y STRENGTH RADIUS          pulls toward (X, Y); STRENGTH < 0 repels
+    //   vortex = X Y STRENGTH RADIUS             circles (X, Y) counterclockwise
+    //   wind = X Y                               the same push everywhere
+    //   turbulence = STRENGTH WAVELENGTH [SEED]  drifting swirls WAVELENGTH across
+    std::vector<ForceSource> forces;
+    float fieldCell = ForceField::DEFAULT_CELL_SIZE; // field-cell, world units between samples
+
+    size_t poolCapacity = 0;              // pool-capacity; 0 sizes the pool by poolSize()
+    std::string removalPolicy = "stable"; // removal-policy, stable or swap (see ParticleSystem.h)
+    unsigned threadCount = 0;             // threads; 0 means hardware concurrency
+    std::string renderer = "sfml";        // renderer, sfml or cpu (see RenderBackend.h)
+    size_t exportQueue = 4;               // export-queue, frames --export may have in flight
+
+    /// set the field named key from its text value;
+    /// throws std::runtime_error for an unknown key or a malformed or out-of-range value
+    void set(std::string const& key, std::string const& value);
+
+    /// apply every `key = value` line of the file at path;
+    /// throws std::runtime_error if it cannot be read or a line is invalid
+    void load(std::string const& path);
+
+    /// particles to reserve up front: poolCapacity if set, otherwise the most
+    /// that can be alive at once, particlesPerSecond * ttl
+    size_t poolSize() const;
+
+    /// colors in the spawn palette, one per particle spawned over a rainbow cycle:
+    /// particlesPerSecond * secondsPerRainbowCycle, kept within [2, MAX_PALETTE_SIZE]
+    size_t paletteSize() const;
+};
+
+/// value as a whole number in [min, max], written as plain decimal digits;
+/// throws std::runtime_error naming key otherwise
+uint64_t parse_integer(std::string const& key, std::string const& value, uint64_t min,
+    uint64_t max);
@@ -0,0 +1,15 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/// resize v to size, at least doubling its capacity whenever it has to grow, so a
+/// size that creeps up to a new peak every frame reallocates O(log n) times instead
+/// of at every peak, and a steady size never does
+template <class T> void grow_to(std::vector<T>& v, size_t size)
+{
+    if (size > v.capacity()) {
+        v.reserve(std::max(size, 2 * v.capacity()));
+    }
+    v.resize(size);
+}
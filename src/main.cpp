@@ -1,10 +1,125 @@
+#include "AllocationTracker.h"
 #include "Engine.h"
+#include "Random.h"
 
-int main()
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+int main(int argc, char* argv[])
 {
-    // Declare an instance of Engine
-    Engine engine;
-    // Start the engine
-    engine.run();
+    Config config;
+    bool headless = false;
+    int frames = 600;
+    char const* recordPath = nullptr;
+    char const* replayPath = nullptr;
+    char const* tracePath = nullptr;
+    char const* exportPath = nullptr;
+    bool forbidAllocations = false;
+
+    // --headless [frames] steps the simulation without a window and prints timings
+    // --seed N replays the run drawn from that seed (default: random)
+    // --record FILE saves the windowed run's input to FILE on exit
+    // --replay FILE steps the simulation through a recorded run without a window
+    // --trace FILE writes the run's profile as Chrome trace JSON to FILE
+    // --export FILE writes every frame to FILE.y4m or numbered FILE_000000.ppm images;
+    //   needs --renderer cpu
+    // --no-alloc aborts on any heap allocation in update or draw after warm-up
+    // --config FILE applies a file of config keys (see config.h)
+    // --KEY VALUE sets one config key, e.g. --threads 4 or --particles-per-second 3000;
+    //   flags apply in order, so later ones override earlier ones and --config files
+    try {
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--headless") == 0) {
+                headless = true;
+                if (i + 1 < argc && argv[i + 1][0] != '-') {
+                    frames = parse_integer("headless", argv[++i], 1, 1'000'000'000);
+                }
+            } else if (std::strcmp(argv[i], "--no-alloc") == 0) {
+                forbidAllocations = true;
+            } else if (std::strncmp(argv[i], "--", 2) != 0 || i + 1 == argc) {
+                throw std::runtime_error(std::string("Error: unexpected argument ") + argv[i]);
+            } else if (std::strcmp(argv[i], "--seed") == 0) {
+                seed_random(parse_integer("seed", argv[++i], 0, UINT64_MAX));
+            } else if (std::strcmp(argv[i], "--record") == 0) {
+                recordPath = argv[++i];
+            } else if (std::strcmp(argv[i], "--replay") == 0) {
+                replayPath = argv[++i];
+            } else if (std::strcmp(argv[i], "--trace") == 0) {
+                tracePath = argv[++i];
+            } else if (std::strcmp(argv[i], "--export") == 0) {
+                exportPath = argv[++i];
+            } else if (std::strcmp(argv[i], "--config") == 0) {
+                config.load(argv[++i]);
+            } else {
+                config.set(argv[i] + 2, argv[i + 1]);
+                i++;
+            }
+        }
+
+        // only a windowed run has live input to record
+        if (recordPath && (headless || replayPath)) {
+            throw std::runtime_error(
+                "Error: --record needs a windowed run, not --headless or --replay");
+        }
+
+        // fail before a window opens or a run starts, not at the first exported frame
+        if (exportPath) {
+            if (config.renderer != "cpu") {
+                throw std::runtime_error("Error: --export needs --renderer cpu");
+            }
+            FrameExporter::formatOf(exportPath);
+        }
+
+        if (forbidAllocations && !allocation_tracking_enabled()) {
+            std::cerr << "--no-alloc has no effect: build with -DTRACK_ALLOCATIONS" << std::endl;
+        }
+
+        if (replayPath) {
+            InputRecording const recording = InputRecording::load(replayPath);
+            Engine engine(config, true);
+            if (tracePath) {
+                engine.trace(tracePath);
+            }
+            if (exportPath) {
+                engine.exportFrames(exportPath);
+            }
+            engine.forbidAllocations(forbidAllocations);
+            engine.replay(recording);
+            return 0;
+        }
+
+        if (headless) {
+            Engine engine(config, true);
+            if (tracePath) {
+                engine.trace(tracePath);
+            }
+            if (exportPath) {
+                engine.exportFrames(exportPath);
+            }
+            engine.forbidAllocations(forbidAllocations);
+            engine.runHeadless(frames);
+            return 0;
+        }
+
+        // Declare an instance of Engine
+        Engine engine(config);
+        if (recordPath) {
+            engine.record(recordPath);
+        }
+        if (tracePath) {
+            engine.trace(tracePath);
+        }
+        if (exportPath) {
+            engine.exportFrames(exportPath);
+        }
+        engine.forbidAllocations(forbidAllocations);
+        // Start the engine
+        engine.run();
+    } catch (std::exception const& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
     // Quit in the usual way when the engine is stopped
 }
@@ -1,13 +1,11 @@
 #pragma once
 #include "../lib/Color_Space.h"
+#include "Random.h"
 #include "config.h"
 #include <SFML/Graphics.hpp>
-#include <random>
+#include <algorithm>
 
-inline int getRandInt(int const min, int const max)
-{
-    return (std::rand() % (max - min + 1)) + min;
-}
+inline int getRandInt(int const min, int const max) { return thread_rng().nextInt(min, max); }
 
 inline int getRandOddInt(int const min, int const max)
 {
@@ -15,12 +13,9 @@ inline int getRandOddInt(int const min, int const max)
     return randInt % 2 ? randInt : randInt - 1;
 }
 
-// Mersenne Twister engine
 inline double getRandDouble(double min, double max)
 {
-    static thread_local std::mt19937 generator(std::random_device {}());
-    std::uniform_real_distribution<double> distribution(min, max);
-    return distribution(generator);
+    return thread_rng().nextDouble(min, max);
 }
 
 inline sf::Uint8 to_u8(float x)
@@ -65,14 +60,14 @@ inline std::vector<sf::Color> get_rainbow_colors(
     std::vector<sf::Color> colors;
     colors.reserve(sample_count);
 
+    clrspc::Ok_Lch_Hue_Table const hues(LIGHTNESS, CHROMA);
+
     for (int i = 0; i < sample_count; ++i) {
 
         float const hue
             = clrspc::normalize_degrees(start_hue + (sample_degrees * i) / (sample_count - 1));
 
-        clrspc::Ok_Lch_Ab const ok_lch_ab(LIGHTNESS, CHROMA, hue);
-
-        auto const [r, g, b] = ok_lch_ab.to_ok_lab().to_rgb().get_values();
+        auto const [r, g, b] = hues.at(hue);
 
         colors.push_back({ to_u8(r), to_u8(g), to_u8(b) });
     }
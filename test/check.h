@@ -0,0 +1,65 @@
+#pragma once
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Check reporting shared by the test binaries. Every check prints one line with
+// its name, and a failed one also prints what it expected and what it got, so a
+// failure can be diagnosed from the output alone. main() returns
+// checks_finished(), which prints the tally and is 1 if any check failed.
+
+inline int g_checksRun = 0;
+inline int g_checksFailed = 0;
+
+/// record a check of passed; detail, if any, is printed when it fails
+inline bool check(std::string const& name, bool passed, std::string const& detail = "")
+{
+    g_checksRun++;
+    if (passed) {
+        std::cout << "  ok    " << name << std::endl;
+    } else {
+        g_checksFailed++;
+        std::cout << "  FAIL  " << name << (detail.empty() ? "" : ": " + detail) << std::endl;
+    }
+    return passed;
+}
+
+/// check that actual == expected, printing both on failure
+template <class A, class E>
+bool check_equal(std::string const& name, A const& actual, E const& expected)
+{
+    std::ostringstream detail;
+    detail << "expected " << expected << ", got " << actual;
+    return check(name, actual == expected, detail.str());
+}
+
+/// check that actual is within tolerance of expected, printing both on failure
+inline bool check_near(std::string const& name, double actual, double expected, double tolerance)
+{
+    std::ostringstream detail;
+    detail << "expected " << expected << " +- " << tolerance << ", got " << actual;
+    return check(name, std::abs(actual - expected) <= tolerance, detail.str());
+}
+
+/// check that fn() throws a std::exception whose message contains text
+template <class Fn> bool check_throws(std::string const& name, Fn&& fn, std::string const& text)
+{
+    try {
+        fn();
+    } catch (std::exception const& e) {
+        std::string const message = e.what();
+        return check(name, message.find(text) != std::string::npos,
+            "expected an error containing '" + text + "', got '" + message + "'");
+    }
+    return check(name, false, "expected an error containing '" + text + "', got none");
+}
+
+/// print the tally; the exit status for main()
+inline int checks_finished()
+{
+    std::cout << g_checksRun - g_checksFailed << " / " << g_checksRun << " checks passed"
+              << std::endl;
+    return g_checksFailed == 0 ? 0 : 1;
+}
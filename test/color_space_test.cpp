@@ -0,0 +1,87 @@
+// Checks of lib/Color_Space.h's lookup tables and structure-of-arrays batch
+// conversions against the exact per-color conversions.
+//
+// usage: color_space_test; exits 1 if any check fails
+
+#include "../lib/Color_Space.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+int main()
+{
+    std::cout << "Testing color lookup tables against exact conversions..." << std::endl;
+    float srgbError = 0;
+    for (int c = 0; c < 256; c++) {
+        srgbError = std::max(srgbError,
+            std::abs(clrspc::srgb_to_linear(c) - clrspc::srgb_decode(c)) * 255.f);
+    }
+    for (int i = 0; i <= 100000; i++) {
+        float const linear = i / 100000.f;
+        srgbError = std::max(
+            srgbError, std::abs(clrspc::linear_to_srgb(linear) - clrspc::srgb_encode(linear)));
+    }
+    float hueError = 0;
+    clrspc::Ok_Lch_Hue_Table const hues(0.7f, 0.18f);
+    for (int i = 0; i < 3600; i++) {
+        float const hue = i / 10.f;
+        auto const exact = clrspc::Ok_Lch_Ab(0.7f, 0.18f, hue).to_ok_lab().to_rgb().get_values();
+        auto const lookup = hues.at(hue);
+        for (int k = 0; k < 3; k++) {
+            hueError = std::max(hueError, std::abs(lookup[k] - exact[k]));
+        }
+    }
+    // errors are in 0-255 channel units; half a unit would change a rounded channel
+    check_near("sRGB tables match the exact transfer functions", srgbError, 0, 0.005);
+    check_near("OkLCh hue table matches exact conversions", hueError, 0, 0.1);
+
+    std::cout << "Testing batch OkLab conversions against exact conversions..." << std::endl;
+    std::vector<float> red, green, blue;
+    for (int i = 0; i <= 255; i += 15) {
+        for (int j = 0; j <= 255; j += 15) {
+            for (int k = 0; k <= 255; k += 15) {
+                red.push_back(i);
+                green.push_back(j);
+                blue.push_back(k);
+            }
+        }
+    }
+    size_t const colorCount = red.size();
+    std::vector<float> labL(colorCount), labA(colorCount), labB(colorCount);
+    std::vector<float> rgbR(colorCount), rgbG(colorCount), rgbB(colorCount);
+    clrspc::rgb_to_ok_lab(red.data(), green.data(), blue.data(), labL.data(), labA.data(),
+        labB.data(), colorCount);
+    clrspc::ok_lab_to_rgb(labL.data(), labA.data(), labB.data(), rgbR.data(), rgbG.data(),
+        rgbB.data(), colorCount);
+    // lightness, chroma and hue reuse the rgb sweep scaled into OkLCh ranges
+    std::vector<float> lchL(colorCount), lchC(colorCount), lchH(colorCount);
+    for (size_t i = 0; i < colorCount; i++) {
+        lchL[i] = red[i] / 255.f;
+        lchC[i] = green[i] / 255.f * 0.4f;
+        lchH[i] = blue[i] / 255.f * 720.f - 180.f;
+    }
+    std::vector<float> lchA(colorCount), lchB(colorCount);
+    clrspc::ok_lch_ab_to_ok_lab(lchL.data(), lchC.data(), lchH.data(), lchL.data(), lchA.data(),
+        lchB.data(), colorCount);
+    float labError = 0;
+    float rgbError = 0;
+    for (size_t i = 0; i < colorCount; i++) {
+        auto const lab = clrspc::Rgb(red[i], green[i], blue[i]).to_ok_lab().get_values();
+        auto const rgb = clrspc::Ok_Lab(labL[i], labA[i], labB[i]).to_rgb().get_values();
+        auto const lch
+            = clrspc::Ok_Lch_Ab(0, green[i] / 255.f * 0.4f, blue[i] / 255.f * 720.f - 180.f)
+                  .to_ok_lab()
+                  .get_values();
+        labError = std::max({ labError, std::abs(lab[0] - labL[i]), std::abs(lab[1] - labA[i]),
+            std::abs(lab[2] - labB[i]), std::abs(lch[1] - lchA[i]), std::abs(lch[2] - lchB[i]) });
+        rgbError = std::max({ rgbError, std::abs(rgb[0] - rgbR[i]), std::abs(rgb[1] - rgbG[i]),
+            std::abs(rgb[2] - rgbB[i]) });
+    }
+    check_near("batch sRGB and OkLCh to OkLab match exact conversions", labError, 0, 1e-5);
+    check_near("batch OkLab to sRGB matches exact conversions", rgbError, 0, 0.01);
+
+    return checks_finished();
+}
@@ -0,0 +1,96 @@
+// Checks of Config: keys set from text, config files with comments, the derived
+// pool and palette sizes, and every kind of value it must reject.
+//
+// usage: config_test; writes scratch files next to itself and exits 1 if any check
+// fails
+
+#include "config.h"
+#include "check.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+int main(int, char* argv[])
+{
+    std::string const path = std::string(argv[0]) + ".conf";
+
+    std::cout << "Testing config keys and files..." << std::endl;
+    Config config;
+    config.set("particles-per-second", "3000");
+    config.set("gravity", "-9.5");
+    config.set("removal-policy", "swap");
+    config.set("renderer", "cpu");
+    config.set("attractor", "10 -20 500 75.5");
+    check_equal("particles-per-second", config.particlesPerSecond, 3000);
+    check_equal("gravity", config.gravity, -9.5f);
+    check_equal("removal-policy", config.removalPolicy, std::string("swap"));
+    check_equal("renderer", config.renderer, std::string("cpu"));
+    check_equal("force sources", config.forces.size(), size_t(1));
+    check_equal("attractor radius", config.forces.empty() ? 0.f : config.forces[0].radius, 75.5f);
+
+    std::ofstream(path) << "# a comment line\n"
+                           "\n"
+                           "  ttl = 4   # trailing comment\n"
+                           "window-title = Two words\r\n"
+                           "threads=3\n";
+    config.load(path);
+    check_equal("ttl from a file", config.ttl, 4.f);
+    check_equal("window-title keeps inner spaces", config.windowTitle, std::string("Two words"));
+    check_equal("threads without spaces around =", config.threadCount, 3u);
+    // 3000 per second for 4 seconds
+    check_equal("poolSize", config.poolSize(), size_t(12000));
+    config.set("pool-capacity", "500");
+    check_equal("poolSize with pool-capacity", config.poolSize(), size_t(500));
+    check_equal("paletteSize", config.paletteSize(), size_t(15000));
+    config.set("particles-per-second", "0");
+    check_equal("paletteSize at least 2", config.paletteSize(), size_t(2));
+    check_equal("parse_integer up to 2^64 - 1",
+        parse_integer("seed", "18446744073709551615", 0, UINT64_MAX), UINT64_MAX);
+
+    std::cout << "Testing rejected values..." << std::endl;
+    struct Rejected {
+        char const* key;
+        char const* value;
+        char const* error;
+    };
+    for (Rejected const& r : std::initializer_list<Rejected> {
+             { "no-such-key", "1", "unknown config key no-such-key" },
+             { "window-width", "", "invalid value '' for window-width" },
+             { "window-width", "wide", "invalid value" },
+             { "window-width", "0", "invalid value" },
+             { "window-width", "16385", "invalid value" },
+             { "window-width", "800px", "invalid value" },
+             { "window-width", "800.0", "invalid value" },
+             { "window-width", "8e2", "invalid value" },
+             { "window-width", "-800", "invalid value" },
+             { "window-width", "+800", "invalid value" },
+             { "pool-capacity", "99999999999999999999999", "invalid value" },
+             { "gravity", "nan", "invalid value" },
+             { "gravity", "inf", "invalid value" },
+             { "gravity", "1e7", "invalid value" },
+             { "ttl", "0", "invalid value" },
+             { "collide-edges", "2", "invalid value" },
+             { "attractor", "1 2 3", "invalid value" },
+             { "attractor", "1 2 3 0", "invalid value" },
+             { "wind", "1 2 3", "invalid value" },
+             { "turbulence", "10 20 1.5", "invalid value" },
+             { "removal-policy", "fifo", "invalid value" },
+             { "renderer", "gpu", "invalid value" },
+         }) {
+        check_throws(std::string("reject ") + r.key + " = '" + r.value + "'",
+            [&] { Config().set(r.key, r.value); }, r.error);
+    }
+
+    std::ofstream(path) << "ttl = 2\nthreads 4\n";
+    check_throws("reject a line without =", [&] { Config().load(path); },
+        "expected key = value at " + path + ":2");
+    std::remove(path.c_str());
+    check_throws("reject a missing file", [&] { Config().load(path); },
+        "failed to read config " + path);
+
+    return checks_finished();
+}
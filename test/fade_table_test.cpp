@@ -0,0 +1,48 @@
+// Checks of FadeTable: each row starts at its color and ends at black, darkens
+// steadily in between, and is shared by every particle of that color.
+//
+// usage: fade_table_test; exits 1 if any check fails
+
+#include "FadeTable.h"
+#include "check.h"
+
+#include <SFML/Graphics.hpp>
+#include <iostream>
+#include <string>
+
+namespace sf {
+std::ostream& operator<<(std::ostream& out, Color const& color)
+{
+    return out << "rgba(" << int(color.r) << ", " << int(color.g) << ", " << int(color.b) << ", "
+               << int(color.a) << ")";
+}
+} // namespace sf
+
+int main()
+{
+    std::cout << "Testing fade table rows..." << std::endl;
+    FadeTable fades;
+    for (sf::Color const color : { sf::Color(255, 255, 255), sf::Color(255, 0, 0),
+             sf::Color(30, 144, 255, 128), sf::Color(0, 0, 0) }) {
+        uint32_t const row = fades.row(color);
+        std::string const name = "rgba(" + std::to_string(color.r) + ", " + std::to_string(color.g)
+            + ", " + std::to_string(color.b) + ", " + std::to_string(color.a) + ") ";
+        check_equal(name + "at age 0", fades.at(row, 0), color);
+        check_equal(name + "at age 1", fades.at(row, 1), sf::Color(0, 0, 0, color.a));
+        check_equal(name + "clamped below age 0", fades.at(row, -3), color);
+        check_equal(name + "clamped above age 1", fades.at(row, 7), sf::Color(0, 0, 0, color.a));
+
+        int brightenings = 0;
+        for (int k = 1; k < FadeTable::STEPS; k++) {
+            sf::Color const before = fades.at(row, (k - 1.f) / (FadeTable::STEPS - 1));
+            sf::Color const after = fades.at(row, float(k) / (FadeTable::STEPS - 1));
+            brightenings += after.r > before.r || after.g > before.g || after.b > before.b;
+        }
+        check_equal(name + "steps brighter than the one before", brightenings, 0);
+    }
+
+    check_equal("a seen color reuses its row", fades.row(sf::Color(255, 0, 0)), 1u);
+    check_equal("alpha tells rows apart", fades.row(sf::Color(255, 0, 0, 254)), 4u);
+
+    return checks_finished();
+}
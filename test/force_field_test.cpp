@@ -0,0 +1,82 @@
+// Checks of ForceField: each source's direction, baking onto the grid, and the
+// accelerate() kernels at every SIMD level against sample().
+//
+// usage: force_field_test; exits 1 if any check fails
+
+#include "ForceField.h"
+#include "TransformKernel.h"
+#include "check.h"
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Matrices;
+
+int main()
+{
+    std::cout << "Testing force field baking and batch sampling..." << std::endl;
+    ForceField field;
+    field.add(ForceSource::attractor({ 0, 0 }, 500, 50));
+    field.add(ForceSource::vortex({ 0, 0 }, 300, 80));
+    field.add(ForceSource::wind({ 20, -10 }));
+    field.add(ForceSource::turbulence(100, 120, 7));
+    field.setCellSize(16);
+    sf::FloatRect const fieldBounds(-200, -100, 400, 200);
+    field.bake(fieldBounds, 1.5);
+    // at (100, 0): pulled back toward the origin, swept up (counterclockwise) by the vortex
+    sf::Vector2f const pulled = ForceSource::attractor({ 0, 0 }, 500, 50).at({ 100, 0 }, 0);
+    sf::Vector2f const swept = ForceSource::vortex({ 0, 0 }, 300, 80).at({ 100, 0 }, 0);
+    check("attractor pulls toward its center", pulled.x < 0);
+    check_near("attractor pull is radial", pulled.y, 0, 1e-4);
+    check("vortex turns counterclockwise", swept.y > 0);
+    check_near("vortex push is tangential", swept.x, 0, 1e-4);
+    // grid nodes sample exactly what the sources evaluate to
+    for (sf::Vector2f const node : { sf::Vector2f(-200, -100), sf::Vector2f(-8, 12),
+             sf::Vector2f(184, 92) }) {
+        sf::Vector2f const baked = field.sample(node);
+        sf::Vector2f const exact = field.evaluate(node, 1.5);
+        std::string const at
+            = " at node (" + std::to_string(int(node.x)) + ", " + std::to_string(int(node.y)) + ")";
+        check_near("baked x" + at, baked.x, exact.x, 1e-2);
+        check_near("baked y" + at, baked.y, exact.y, 1e-2);
+    }
+    // every kernel matches sample(), inside the grid and clamped outside it
+    std::vector<float> fieldX(37), fieldY(37), expectedVx(37, 1), expectedVy(37, -1);
+    for (size_t i = 0; i < fieldX.size(); i++) {
+        fieldX[i] = -260 + 14.5f * i;
+        fieldY[i] = -130 + 7.25f * i;
+        // and a non-finite point has no force at all, in a SIMD block and in the tail
+        if (i == 3 || i == 34) {
+            fieldX[i] = std::nanf("");
+        } else if (i == 12) {
+            fieldY[i] = -INFINITY;
+        }
+        sf::Vector2f const a = field.sample({ fieldX[i], fieldY[i] });
+        expectedVx[i] += a.x * 0.5f;
+        expectedVy[i] += a.y * 0.5f;
+    }
+    check_equal("no force at a NaN point", expectedVx[3], 1.f);
+    check_equal("no force at an infinite point", expectedVy[12], -1.f);
+    SimdLevel const simdLevel = get_simd_level();
+    for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 }) {
+        if (set_simd_level(level) != level) {
+            continue;
+        }
+        std::vector<float> vx(37, 1), vy(37, -1);
+        field.accelerate(fieldX.data(), fieldY.data(), vx.data(), vy.data(), vx.size(), 0.5f);
+        float error = 0;
+        for (size_t i = 0; i < vx.size(); i++) {
+            error = std::max({ error, std::abs(vx[i] - expectedVx[i]),
+                std::abs(vy[i] - expectedVy[i]) });
+        }
+        check_near(std::string(to_string(level)) + " accelerate() matches sample()", error, 0,
+            1e-3);
+    }
+    set_simd_level(simdLevel);
+
+    return checks_finished();
+}
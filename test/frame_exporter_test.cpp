@@ -0,0 +1,66 @@
+// Checks of FrameExporter's RGB to YUV 4:2:0 conversion: known BT.601 values, and
+// the SIMD kernels against the scalar one.
+//
+// usage: frame_exporter_test; exits 1 if any check fails
+
+#include "FrameExporter.h"
+#include "TransformKernel.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Matrices;
+
+int main()
+{
+    std::cout << "Testing RGB to YUV 4:2:0 conversion..." << std::endl;
+    // odd sizes so the kernels' partial blocks and tails run too
+    unsigned const yuvWidth = 21;
+    unsigned const yuvHeight = 5;
+    unsigned const lumaSize = yuvWidth * yuvHeight;
+    unsigned const chromaSize = ((yuvWidth + 1) / 2) * ((yuvHeight + 1) / 2);
+    std::vector<uint8_t> rgba(4 * yuvWidth * yuvHeight);
+    uint32_t noise = 12345;
+    for (uint8_t& channel : rgba) {
+        noise = noise * 1664525 + 1013904223;
+        channel = static_cast<uint8_t>(noise >> 24);
+    }
+    uint8_t const pureRed[] = { 255, 0, 0, 255 };
+    std::copy(pureRed, pureRed + 4, rgba.begin()); // a lone red pixel in the first block
+    std::vector<uint8_t> expectedYuv(lumaSize + 2 * chromaSize);
+    SimdLevel const simdLevel = get_simd_level();
+    set_simd_level(SimdLevel::Scalar);
+    rgba_to_yuv420(rgba.data(), yuvWidth, yuvHeight, expectedYuv.data(), &expectedYuv[lumaSize],
+        &expectedYuv[lumaSize + chromaSize]);
+    check_equal("BT.601 luma of red", int(expectedYuv[0]), 82);
+    for (SimdLevel level : { SimdLevel::Sse2, SimdLevel::Avx2 }) {
+        if (set_simd_level(level) != level) {
+            continue;
+        }
+        std::vector<uint8_t> actualYuv(expectedYuv.size());
+        rgba_to_yuv420(rgba.data(), yuvWidth, yuvHeight, actualYuv.data(), &actualYuv[lumaSize],
+            &actualYuv[lumaSize + chromaSize]);
+        // where the output first differs from scalar locates a kernel's mistake
+        size_t const firstDifference
+            = std::mismatch(actualYuv.begin(), actualYuv.end(), expectedYuv.begin()).first
+            - actualYuv.begin();
+        check_equal(std::string(to_string(level)) + " bytes matching scalar", firstDifference,
+            actualYuv.size());
+    }
+    set_simd_level(simdLevel);
+    // a white 2x2 block is Y 235 and neutral chroma
+    uint8_t const white[16] = { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255 };
+    uint8_t whiteYuv[6];
+    rgba_to_yuv420(white, 2, 2, whiteYuv, whiteYuv + 4, whiteYuv + 5);
+    check_equal("BT.601 luma of white", int(whiteYuv[0]), 235);
+    check_equal("BT.601 luma of white, last pixel", int(whiteYuv[3]), 235);
+    check_equal("BT.601 U of white", int(whiteYuv[4]), 128);
+    check_equal("BT.601 V of white", int(whiteYuv[5]), 128);
+
+    return checks_finished();
+}
@@ -0,0 +1,93 @@
+// Checks of InputRecording: a save/load round trip of every field, the file layout,
+// and the errors for truncated, foreign and missing files.
+//
+// usage: input_recording_test; writes scratch files next to itself and exits 1 if
+// any check fails
+
+#include "InputRecording.h"
+#include "check.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<char> read_file(std::string const& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+void write_file(std::string const& path, std::vector<char> const& bytes)
+{
+    std::ofstream(path, std::ios::binary).write(bytes.data(), bytes.size());
+}
+} // namespace
+
+int main(int, char* argv[])
+{
+    std::string const path = std::string(argv[0]) + ".pinp";
+    std::string const damagedPath = std::string(argv[0]) + ".damaged.pinp";
+
+    std::cout << "Testing an input recording round trip..." << std::endl;
+    InputRecording recording;
+    recording.seed = 0xfedcba9876543210;
+    recording.frames.push_back({ 1 / 60.f, -5, 1079, 1920, 1080, true });
+    recording.frames.push_back({ 0.25f, 2'000'000'000, -2'000'000'000, 65535, 1, false });
+    recording.frames.push_back({});
+    recording.save(path);
+
+    std::vector<char> const bytes = read_file(path);
+    // "PINP", version, seed, frame count, then 17 bytes a frame
+    check_equal("file size", bytes.size(), size_t(4 + 4 + 8 + 4 + 17 * 3));
+    check_equal("magic", std::string(bytes.data(), 4), std::string("PINP"));
+
+    InputRecording const loaded = InputRecording::load(path);
+    check_equal("seed", loaded.seed, recording.seed);
+    check_equal("frame count", loaded.frames.size(), recording.frames.size());
+    for (size_t f = 0; f < loaded.frames.size() && f < recording.frames.size(); f++) {
+        InputFrame const& expected = recording.frames[f];
+        InputFrame const& actual = loaded.frames[f];
+        std::string const frame = "frame " + std::to_string(f) + " ";
+        check_equal(frame + "dt", actual.dtAsSeconds, expected.dtAsSeconds);
+        check_equal(frame + "mouse x", actual.mouseX, expected.mouseX);
+        check_equal(frame + "mouse y", actual.mouseY, expected.mouseY);
+        check_equal(frame + "viewport width", actual.viewportWidth, expected.viewportWidth);
+        check_equal(frame + "viewport height", actual.viewportHeight, expected.viewportHeight);
+        check_equal(frame + "left button", actual.mouseLeftPressed, expected.mouseLeftPressed);
+    }
+
+    std::cout << "Testing damaged and foreign files..." << std::endl;
+    std::vector<char> damaged(bytes.begin(), bytes.end() - 1);
+    write_file(damagedPath, damaged);
+    check_throws("a frame cut short", [&] { InputRecording::load(damagedPath); },
+        "truncated input recording");
+    damaged = bytes;
+    damaged.push_back(0);
+    write_file(damagedPath, damaged);
+    check_throws("a trailing byte", [&] { InputRecording::load(damagedPath); },
+        "truncated input recording");
+    write_file(damagedPath, std::vector<char>(bytes.begin(), bytes.begin() + 10));
+    check_throws("a header cut short", [&] { InputRecording::load(damagedPath); },
+        "is not an input recording");
+    damaged = bytes;
+    damaged[0] = 'X';
+    write_file(damagedPath, damaged);
+    check_throws("the wrong magic", [&] { InputRecording::load(damagedPath); },
+        "is not an input recording");
+    damaged = bytes;
+    damaged[4]++;
+    write_file(damagedPath, damaged);
+    check_throws("another version", [&] { InputRecording::load(damagedPath); },
+        "unsupported input recording version");
+    std::remove(damagedPath.c_str());
+    check_throws("a missing file", [&] { InputRecording::load(damagedPath); },
+        "is not an input recording");
+    std::remove(path.c_str());
+
+    return checks_finished();
+}
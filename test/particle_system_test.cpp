@@ -0,0 +1,126 @@
+// Checks of ParticleSystem's closed-form motion, setMotion() and both removal
+// policies.
+//
+// usage: particle_system_test; exits 1 if any check fails
+
+#include "ParticleSystem.h"
+#include "Random.h"
+#include "check.h"
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+ParticleSystem::Physics const PHYSICS { 1000, 1000, 0.5f }; // long lives, halving each second
+
+/// the first outline point of the system's only particle, relative to its center
+sf::Vector2f first_spoke(ParticleSystem const& system)
+{
+    system.buildBatch();
+    sf::Vertex const* fan = system.getBatch();
+    return fan[1].position - fan[0].position;
+}
+
+/// the removal order a policy leaves: each survivor's spawn x, which tags it
+std::vector<int> survivors_after_removal(ParticleSystem::RemovalPolicy policy)
+{
+    ParticleSystem system;
+    system.setPhysics(PHYSICS);
+    system.setRemovalPolicy(policy);
+    for (int k = 0; k < 6; k++) {
+        system.spawn(sf::Color::White, { 100.f * k, 0 });
+    }
+    system[1].update(1e6);
+    system[3].update(1e6);
+    system.removeDead();
+
+    std::vector<int> tags;
+    for (size_t i = 0; i < system.size(); i++) {
+        tags.push_back(static_cast<int>(std::lround(system.getCenter(i).x / 100)));
+    }
+    return tags;
+}
+
+std::string to_string(std::vector<int> const& values)
+{
+    std::string text;
+    for (int v : values) {
+        text += (text.empty() ? "" : " ") + std::to_string(v);
+    }
+    return "[" + text + "]";
+}
+} // namespace
+
+int main()
+{
+    seed_random(1);
+
+    std::cout << "Testing closed-form ballistic motion..." << std::endl;
+    ParticleSystem system;
+    system.setPhysics(PHYSICS);
+    sf::Vector2f const origin(10, 20);
+    system.seek(1);
+    system.spawn(sf::Color::Red, origin);
+    sf::Vector2f const v = system.getVelocity(0);
+    check_near("spawn center x", system.getCenter(0).x, origin.x, 1e-4);
+    check_near("spawn center y", system.getCenter(0).y, origin.y, 1e-4);
+    check("spawn vx within [-500, 500]", v.x >= -500 && v.x <= 500);
+    check("spawn vy within [100, 500]", v.y >= 100 && v.y <= 500);
+    check("visible once spawned", system.isVisible(0));
+    sf::Vector2f const spoke = first_spoke(system);
+
+    // center = origin + v * age - (0, g * age^2 / 2)
+    float const age = 0.5f;
+    float const g = PHYSICS.gravity;
+    system.update(age);
+    check_near("center x at 0.5 s", system.getCenter(0).x, origin.x + v.x * age, 1e-3);
+    check_near("center y at 0.5 s", system.getCenter(0).y,
+        origin.y + v.y * age - g * age * age / 2, 1e-3);
+    check_near("velocity y at 0.5 s", system.getVelocity(0).y, v.y - g * age, 1e-3);
+
+    // scale = scalePerSecond^age; angle = angle at spawn + spin * age, spin 0 or pi
+    sf::Vector2f const aged = first_spoke(system);
+    float const length = std::hypot(spoke.x, spoke.y);
+    check_near("outline scale at 0.5 s", std::hypot(aged.x, aged.y) / length,
+        std::pow(PHYSICS.scalePerSecond, age), 1e-4);
+    float const turned
+        = std::remainder(std::atan2(aged.y, aged.x) - std::atan2(spoke.y, spoke.x), 2 * M_PI);
+    check("outline turned by 0 or pi * age",
+        std::abs(turned) < 1e-3 || std::abs(turned - M_PI * age) < 1e-3,
+        "turned " + std::to_string(turned) + " radians");
+
+    system.seek(0.5);
+    check("hidden before its spawn time", !system.isVisible(0));
+    system.seek(1 + age);
+
+    std::cout << "Testing setMotion()..." << std::endl;
+    sf::Vector2f const position(-30, 75);
+    sf::Vector2f const velocity(40, -60);
+    system.setMotion(0, position, velocity);
+    check_near("center x right after", system.getCenter(0).x, position.x, 1e-3);
+    check_near("center y right after", system.getCenter(0).y, position.y, 1e-3);
+    check_near("velocity x right after", system.getVelocity(0).x, velocity.x, 1e-3);
+    check_near("velocity y right after", system.getVelocity(0).y, velocity.y, 1e-3);
+    // and it falls from there, forward and back in time
+    for (float dt : { 0.25f, -0.5f }) {
+        system.seek(1 + age + dt);
+        std::string const when = dt > 0 ? " 0.25 s later" : " 0.5 s earlier";
+        check_near("center x" + when, system.getCenter(0).x, position.x + velocity.x * dt, 1e-3);
+        check_near("center y" + when, system.getCenter(0).y,
+            position.y + velocity.y * dt - g * dt * dt / 2, 1e-3);
+    }
+
+    std::cout << "Testing removal policies..." << std::endl;
+    // particles 1 and 3 of 0-5 expire
+    check_equal("Stable keeps spawn order",
+        to_string(survivors_after_removal(ParticleSystem::RemovalPolicy::Stable)),
+        std::string("[0 2 4 5]"));
+    check_equal("SwapAndPop fills each hole from the end",
+        to_string(survivors_after_removal(ParticleSystem::RemovalPolicy::SwapAndPop)),
+        std::string("[0 5 2 4]"));
+
+    return checks_finished();
+}
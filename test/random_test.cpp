@@ -0,0 +1,137 @@
+// Checks of Random: xoshiro256** against the reference algorithm, the bounds of
+// Lemire's nextInt and of nextDouble, and seed_random() replaying a run.
+//
+// usage: random_test; exits 1 if any check fails
+
+#include "Random.h"
+#include "check.h"
+
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+// the reference splitmix64 and xoshiro256** from https://prng.di.unimi.it, written
+// out independently of Random.cpp
+uint64_t reference_splitmix64(uint64_t& x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+uint64_t reference_xoshiro(uint64_t s[4])
+{
+    auto const rotl = [](uint64_t x, int k) { return (x << k) | (x >> (64 - k)); };
+    uint64_t const result = rotl(s[1] * 5, 7) * 9;
+    uint64_t const t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+std::vector<int> draw_ints(Rng& rng, int n)
+{
+    std::vector<int> values(n);
+    rng.fillInt(values.data(), n, -1000, 1000);
+    return values;
+}
+} // namespace
+
+int main()
+{
+    std::cout << "Testing the generator against the reference algorithm..." << std::endl;
+    // splitmix64's first output for seed 0, as published
+    uint64_t splitmixState = 0;
+    check_equal("splitmix64(0)", reference_splitmix64(splitmixState), 0xe220a8397b1dcdafULL);
+    for (uint64_t seed : { uint64_t(0), uint64_t(42), UINT64_MAX }) {
+        uint64_t state[4];
+        uint64_t expand = seed;
+        for (uint64_t& word : state) {
+            word = reference_splitmix64(expand);
+        }
+        Rng rng(seed);
+        int firstDifference = -1;
+        for (int k = 0; k < 1000 && firstDifference < 0; k++) {
+            firstDifference = rng.next() == reference_xoshiro(state) ? -1 : k;
+        }
+        check_equal("seed " + std::to_string(seed) + ": first draw differing from reference",
+            firstDifference, -1);
+    }
+
+    std::cout << "Testing bounds..." << std::endl;
+    Rng rng(7);
+    // a small range must stay inside and reach both ends
+    std::vector<int> seen(7);
+    int outside = 0;
+    for (int k = 0; k < 10000; k++) {
+        int const value = rng.nextInt(-3, 3);
+        if (value < -3 || value > 3) {
+            outside++;
+        } else {
+            seen[value + 3]++;
+        }
+    }
+    check_equal("nextInt(-3, 3) draws outside the range", outside, 0);
+    int missing = 0;
+    for (int count : seen) {
+        missing += count == 0;
+    }
+    check_equal("nextInt(-3, 3) values never drawn", missing, 0);
+    check_equal("nextInt(5, 5)", rng.nextInt(5, 5), 5);
+    // the full range wraps the width to 0, which takes its own path
+    bool negative = false;
+    bool positive = false;
+    for (int k = 0; k < 100; k++) {
+        int const value = rng.nextInt(INT_MIN, INT_MAX);
+        negative = negative || value < 0;
+        positive = positive || value > 0;
+    }
+    check("nextInt(INT_MIN, INT_MAX) draws both signs", negative && positive);
+    // a width of 3 * 2^30: 32 random bits taken modulo it would land in the lowest
+    // third twice as often as in each of the others
+    int lowestThird = 0;
+    int const draws = 30000;
+    for (int k = 0; k < draws; k++) {
+        lowestThird += rng.nextInt(INT_MIN, (1 << 30) - 1) < -(1 << 30);
+    }
+    check_near("nextInt over 3 * 2^30 values: share in the lowest third",
+        double(lowestThird) / draws, 1 / 3.0, 0.02);
+    int outsideDouble = 0;
+    for (int k = 0; k < 10000; k++) {
+        double const value = rng.nextDouble(-2, 0.5);
+        outsideDouble += value < -2 || value >= 0.5;
+    }
+    check_equal("nextDouble(-2, 0.5) draws outside [-2, 0.5)", outsideDouble, 0);
+
+    std::cout << "Testing seed_random determinism..." << std::endl;
+    Rng first(99);
+    Rng second(99);
+    check("equal seeds draw equal sequences", draw_ints(first, 100) == draw_ints(second, 100));
+    Rng other(100);
+    first.seed(99);
+    check("different seeds draw different sequences",
+        draw_ints(first, 100) != draw_ints(other, 100));
+
+    seed_random(1234);
+    check_equal("get_random_seed", get_random_seed(), uint64_t(1234));
+    std::vector<int> const run = draw_ints(thread_rng(), 100);
+    std::vector<int> workerRun;
+    std::thread([&] { workerRun = draw_ints(thread_rng(), 100); }).join();
+    seed_random(1234);
+    check("reseeding replays the calling thread's draws", draw_ints(thread_rng(), 100) == run);
+    std::vector<int> workerReplay;
+    std::thread([&] { workerReplay = draw_ints(thread_rng(), 100); }).join();
+    check("reseeding replays the next thread's draws", workerReplay == workerRun);
+    check("threads draw from different streams", workerRun != run);
+
+    return checks_finished();
+}
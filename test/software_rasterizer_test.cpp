@@ -0,0 +1,67 @@
+// Checks of SoftwareRasterizer's fill rules and color interpolation.
+//
+// usage: software_rasterizer_test; exits 1 if any check fails
+
+#include "SoftwareRasterizer.h"
+#include "ThreadPool.h"
+#include "check.h"
+
+#include <SFML/Graphics.hpp>
+#include <iostream>
+
+namespace sf {
+std::ostream& operator<<(std::ostream& out, Color const& color)
+{
+    return out << "rgba(" << int(color.r) << ", " << int(color.g) << ", " << int(color.b) << ", "
+               << int(color.a) << ")";
+}
+} // namespace sf
+
+int main()
+{
+    std::cout << "Testing the CPU rasterizer's fill rules and interpolation..." << std::endl;
+    ThreadPool rasterPool(1);
+    SoftwareRasterizer raster(rasterPool);
+    // two half-transparent triangles sharing a diagonal: every pixel of the square
+    // must be blended exactly once, or the diagonal shows
+    sf::Color const halfRed(255, 0, 0, 128);
+    sf::Vertex const square[] = { { { 2, 2 }, halfRed }, { { 10, 2 }, halfRed },
+        { { 10, 10 }, halfRed }, { { 2, 2 }, halfRed }, { { 10, 10 }, halfRed },
+        { { 2, 10 }, halfRed } };
+    raster.beginFrame({ 16, 16 });
+    raster.drawTriangles(square, 6, sf::Transform::Identity);
+    raster.endFrame();
+    int blendedOnce = 0;
+    int touched = 0;
+    for (sf::Color const pixel : raster.getFramebuffer()->pixels) {
+        blendedOnce += pixel == sf::Color(128, 0, 0);
+        touched += pixel != sf::Color::Black;
+    }
+    check_equal("shared edge: pixels touched", touched, 64);
+    check_equal("shared edge: pixels blended exactly once", blendedOnce, 64);
+
+    // pixel (0, 0) is sampled at (0.5, 0.5), 1/16 of the way toward the black corners
+    sf::Vertex const gradient[] = { { { 0, 0 }, sf::Color::White }, { { 16, 0 }, sf::Color::Black },
+        { { 0, 16 }, sf::Color::Black } };
+    raster.beginFrame({ 16, 16 });
+    raster.drawTriangles(gradient, 3, sf::Transform::Identity);
+    raster.endFrame();
+    check_equal("gradient sampled at pixel centers", raster.getFramebuffer()->at(0, 0),
+        sf::Color(239, 239, 239));
+
+    std::cout << "Testing draw order across binned and tile-spanning triangles..." << std::endl;
+    // the small opaque triangle sits in one tile and is binned; the half-transparent
+    // one spans every tile, so it is not, yet must still blend over the first
+    sf::Color const green(0, 255, 0);
+    sf::Vertex const layered[] = { { { 32, 32 }, green }, { { 48, 32 }, green },
+        { { 32, 48 }, green }, { { 0, 0 }, halfRed }, { { 512, 0 }, halfRed },
+        { { 0, 512 }, halfRed } };
+    raster.beginFrame({ 256, 256 });
+    raster.drawTriangles(layered, 6, sf::Transform::Identity);
+    raster.endFrame();
+    check_equal("later large triangle blends over a binned one",
+        raster.getFramebuffer()->at(36, 36), sf::Color(128, 127, 0));
+    check_equal("large triangle alone", raster.getFramebuffer()->at(200, 30), sf::Color(128, 0, 0));
+
+    return checks_finished();
+}
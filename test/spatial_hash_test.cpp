@@ -0,0 +1,59 @@
+// Checks of SpatialHash's neighbour queries against a brute-force search over all pairs.
+//
+// usage: spatial_hash_test; exits 1 if any check fails
+
+#include "SpatialHash.h"
+#include "check.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main()
+{
+    std::cout << "Testing spatial hash neighbour queries against all pairs..." << std::endl;
+    // clustered and scattered points, negative coordinates, and a cell both as large as
+    // the radius and a third of it, the smallest the query stencil allows
+    std::vector<float> hashX(600);
+    std::vector<float> hashY(600);
+    uint32_t noise = 12345;
+    for (size_t i = 0; i < hashX.size(); i++) {
+        noise = noise * 1664525 + 1013904223;
+        float const spread = i % 2 ? 400.f : 40.f;
+        hashX[i] = ((noise >> 8) % 10000) / 10000.f * spread - spread / 2;
+        hashY[i] = ((noise >> 4) % 10000) / 10000.f * spread - spread / 2;
+    }
+    float const queryRadius = 12;
+    for (float cellSize : { queryRadius, queryRadius / 3 }) {
+        SpatialHash hash(cellSize);
+        hash.build(hashX.data(), hashY.data(), hashX.size());
+        size_t wrongCounts = 0;
+        size_t wrongMappings = 0;
+        for (size_t i = 0; i < hashX.size(); i++) {
+            size_t expectedNeighbours = 0;
+            for (size_t j = 0; j < hashX.size(); j++) {
+                float const dx = hashX[j] - hashX[i];
+                float const dy = hashY[j] - hashY[i];
+                expectedNeighbours += dx * dx + dy * dy < queryRadius * queryRadius;
+            }
+            size_t foundNeighbours = 0;
+            hash.forEachCandidate(hashX[i], hashY[i], queryRadius, [&](uint32_t k) {
+                float const dx = hash.sortedX()[k] - hashX[i];
+                float const dy = hash.sortedY()[k] - hashY[i];
+                bool const inside = dx * dx + dy * dy < queryRadius * queryRadius;
+                foundNeighbours += inside;
+                // sorted points must map back to where build() read them
+                uint32_t const original = hash.order()[k];
+                wrongMappings += hashX[original] != hash.sortedX()[k]
+                    || hashY[original] != hash.sortedY()[k];
+            });
+            wrongCounts += foundNeighbours != expectedNeighbours;
+        }
+        std::string const cell = "cell " + std::to_string(int(cellSize)) + ": ";
+        check_equal(cell + "points with a wrong neighbour count", wrongCounts, 0u);
+        check_equal(cell + "sorted points not at their build() position", wrongMappings, 0u);
+    }
+
+    return checks_finished();
+}
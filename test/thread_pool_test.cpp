@@ -0,0 +1,76 @@
+// Checks of ThreadPool::parallelFor: every index covered exactly once in chunks of
+// at most the grain size, and idle threads stealing a busy thread's chunks.
+//
+// usage: thread_pool_test; exits 1 if any check fails
+
+#include "ThreadPool.h"
+#include "check.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    std::cout << "Testing parallelFor coverage..." << std::endl;
+    for (unsigned threads : { 1u, 4u }) {
+        ThreadPool pool(threads);
+        // empty, less than a chunk, a partial last chunk, and more chunks than threads
+        for (size_t count : { size_t(0), size_t(5), size_t(1000), size_t(100'003) }) {
+            size_t const grain = 64;
+            std::vector<std::atomic<int>> visits(count);
+            std::atomic<int> oversized { 0 };
+            pool.parallelFor(count, grain, [&](size_t first, size_t last) {
+                oversized += first >= last || last - first > grain;
+                for (size_t i = first; i < last; i++) {
+                    visits[i]++;
+                }
+            });
+            int wrong = 0;
+            for (std::atomic<int> const& v : visits) {
+                wrong += v != 1;
+            }
+            std::string const run
+                = std::to_string(threads) + " threads, " + std::to_string(count) + " items: ";
+            check_equal(run + "indices not visited exactly once", wrong, 0);
+            check_equal(run + "empty or oversized chunks", oversized.load(), 0);
+        }
+    }
+
+    std::cout << "Testing work stealing..." << std::endl;
+    // the first chunk to start holds its thread until every other chunk is done; the
+    // rest of that thread's queue can then only finish by being stolen
+    ThreadPool pool(4);
+    size_t const chunks = 64;
+    std::atomic<size_t> finished { 0 };
+    std::atomic<bool> claimed { false };
+    size_t doneWhileBlocked = 0;
+    std::mutex threadsMutex;
+    std::set<std::thread::id> threadIds;
+    pool.parallelFor(chunks, 1, [&](size_t, size_t) {
+        {
+            std::lock_guard<std::mutex> lock(threadsMutex);
+            threadIds.insert(std::this_thread::get_id());
+        }
+        if (!claimed.exchange(true)) {
+            auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (finished < chunks - 1 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            doneWhileBlocked = finished;
+        }
+        finished++;
+    });
+    check_equal("chunks done while one thread was blocked (5 s limit)", doneWhileBlocked,
+        chunks - 1);
+    check_equal("chunks finished", finished.load(), chunks);
+    check("more than one thread ran chunks", threadIds.size() > 1,
+        std::to_string(threadIds.size()) + " thread(s)");
+
+    return checks_finished();
+}
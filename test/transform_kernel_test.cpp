@@ -0,0 +1,77 @@
+// Checks of the vertex transform kernels: every SIMD level against transform_points()
+// and bit for bit against the scalar kernel, with strides and tails.
+//
+// usage: transform_kernel_test; exits 1 if any check fails
+
+#include "Matrices.h"
+#include "TransformKernel.h"
+#include "check.h"
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Matrices;
+
+int main()
+{
+    std::cout << "Testing vertex transform kernels up to " << to_string(detect_simd_level())
+              << "..." << std::endl;
+    // 37 points: whole AVX2 and SSE2 blocks, then a tail for each
+    int const count = 37;
+    std::vector<float> xs(count), ys(count);
+    uint32_t noise = 12345;
+    for (int j = 0; j < count; j++) {
+        noise = noise * 1664525 + 1013904223;
+        xs[j] = ((noise >> 8) % 20000) / 10.f - 1000;
+        ys[j] = ((noise >> 4) % 20000) / 10.f - 1000;
+    }
+    AffineMatrix const transform(M_PI / 5.0, 0.9, 3, -7, 12, 6);
+    std::vector<float> exactX = xs, exactY = ys;
+    transform_points(transform, exactX.data(), exactY.data(), count);
+
+    // every other vertex, as the particles' triangle fans use a stride
+    int const stride = 2;
+    sf::Color const untouched(1, 2, 3, 4);
+    std::vector<sf::Vertex> scalar;
+    SimdLevel const simdLevel = get_simd_level();
+    for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 }) {
+        if (set_simd_level(level) != level) {
+            std::cout << "  skip  " << to_string(level) << ": not supported by this CPU"
+                      << std::endl;
+            continue;
+        }
+        std::vector<sf::Vertex> vertices(stride * count, sf::Vertex({ -1, -1 }, untouched));
+        transform_points_to_vertices(
+            transform, xs.data(), ys.data(), count, vertices.data(), stride);
+
+        std::string const name = to_string(level);
+        float error = 0;
+        int strayWrites = 0;
+        for (int j = 0; j < count; j++) {
+            sf::Vector2f const p = vertices[stride * j].position;
+            error = std::max({ error, std::abs(p.x - exactX[j]), std::abs(p.y - exactY[j]) });
+            sf::Vertex const& skipped = vertices[stride * j + 1];
+            strayWrites += skipped.position != sf::Vector2f(-1, -1) || skipped.color != untouched;
+        }
+        check_near(name + " matches transform_points()", error, 0, 1e-3);
+        check_equal(name + " vertices written between strides", strayWrites, 0);
+
+        if (level == SimdLevel::Scalar) {
+            scalar = vertices;
+            continue;
+        }
+        int differing = 0;
+        for (int j = 0; j < count; j++) {
+            differing += vertices[stride * j].position != scalar[stride * j].position;
+        }
+        check_equal(name + " positions differing from scalar", differing, 0);
+    }
+    set_simd_level(simdLevel);
+
+    return checks_finished();
+}